@@ -1,8 +1,7 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
-#include<NTL/ZZ_pXFactoring.h>
-#include<NTL/ZZ_pEXFactoring.h>
+#include<NTL/ZZ_pE.h>
 #include "EE.h"
 
 void mod(ZZ_p& b, const EE& a, const EE& p)
@@ -17,46 +16,145 @@ void mod(ZZ_p& b, const EE& a, const EE& p)
     conv(x, a.x); sub(b, x, y);
 }
 
-void CubRootMod(EE& x, const EE& a, const EE& p)
-// solve x^3 == a (mod p)
-// Assume p is primary prime and (a/p)_3 == 1
-// Assume either
-//   norm(p) is prime and norm(p)==1 (mod 3)
-//   or norm(p) is prime^2 and p==2 (mod 3)
+void mod(ZZ_pE& b, const EE& a)
+// b==a (mod p) where p is rational prime and p==2 (mod 3)
+// Assume ZZ_p::init(p) and ZZ_pE::init(X^2+X+1)
+//   have been executed, so that X represents w
 {
+    ZZ_pX f;
     ZZ_p c;
+    conv(c, a.x); SetCoeff(f,0,c);
+    conv(c, a.y); SetCoeff(f,1,c);
+    conv(b,f);
+}
+
+static void NonResidue(ZZ_p& g, const ZZ& q)
+// g = cubic non-residue in Z/qZ; assume q==1 (mod 3)
+{
+    ZZ e;
+    ZZ_p h;
+    div(e, q-1, 3);
+    for(conv(g,2);; g += 1) {
+        power(h,g,e);
+        if(!IsOne(h)) return;
+    }
+}
+
+static void NonResidue(ZZ_pE& g, const ZZ& q)
+// g = cubic non-residue in F_q = F_p[w]; assume q = p^2
+{
+    ZZ e;
+    ZZ_pE h;
     ZZ_pX f;
+    div(e, q-1, 3);
+    SetCoeff(f,1);
+    for(long k=0;; k++) {
+        SetCoeff(f,0,k);
+        conv(g,f);
+        power(h,g,e);
+        if(!IsOne(h)) return;
+    }
+}
 
+template<class F>
+static void CubRoot(Vec<F>& x, const Vec<F>& a, const F& g, const ZZ& q)
+// x[k] = cube root of a[k] in finite field F of order q
+// Assume a[k] are cubic residues and q==1 (mod 3)
+// g = cubic non-residue in F
+// by Adleman-Manders-Miller algorithm:
+//   let q-1 = 3^s t (t!=0 mod 3), 3e==1 (mod t), z = g^t
+//   then x = a^e y where y^3 = a^{1-3e} in <z> of order 3^s,
+//   and y is found from the discrete log of a^{3e-1} to base z
+{
+    long i,j,k,d,s;
+    ZZ e,t;
+    F c,h,u,v,w,y,z,zeta,zi;
+    sub(t,q,1);
+    for(s=0; divide(t,t,3); s++);
+    if(IsOne(t)) clear(e);
+    else { rem(e, ZZ(3), t); InvMod(e,e,t); }
+    power(z,g,t);
+    inv(zi,z);
+    for(i=1, zeta=z; i<s; i++) power(zeta,zeta,3);
+    x.SetLength(a.length());
+    for(k=0; k<a.length(); k++) {
+        if(IsZero(a[k])) { clear(x[k]); continue; }
+        power(u, a[k], e);
+        power(c, u, 3);
+        c /= a[k];
+        set(y);
+        set(v);
+        for(i=0, w=zi; i<s; i++) {// c = a^{3e-1} y^3
+            for(j=i+1, h=c; j<s; j++) power(h,h,3);
+            if(IsOne(h)) d=0;
+            else if(h==zeta) d=1;
+            else d=2;
+            for(j=0; j<d; j++) { c *= w; y *= v; }
+            v = w;
+            power(w,w,3);
+        }
+        mul(x[k],u,y);
+    }
+}
+
+void CubRootMod(Vec<EE>& x, const Vec<EE>& a, const EE& p)
+// solve x[k]^3 == a[k] (mod p) for k=0,...,a.length()-1
+// with modulus context and cubic non-residue fixed
+// Assume p is primary prime and (a[k]/p)_3 == 1
+// Assume either
+//   norm(p) is prime and norm(p)==1 (mod 3)
+//   or norm(p) is prime^2 and p==2 (mod 3)
+{
+    long k,n(a.length());
+    ZZ q;
+    x.SetLength(n);
     if(!IsZero(p.y)) {// norm(p)==1 (mod 3)
-        ZZ n;
-        norm(n,p);
-        ZZ_pPush _p(n);
-        mod(c,a,p);
-        negate(c,c);
-        SetCoeff(f,3);
-        SetCoeff(f,0,c);
-        FindRoot(c,f);
-        conv(n,c);
-        conv(x,n);
-        x %= p;
+        ZZ_p g;
+        Vec<ZZ_p> b;
+        norm(q,p);
+        ZZ_pPush _p(q);
+        b.SetLength(n);
+        for(k=0; k<n; k++) mod(b[k], a[k], p);
+        NonResidue(g,q);
+        CubRoot(b,b,g,q);
+        for(k=0; k<n; k++) {
+            conv(q, b[k]);
+            conv(x[k], q);
+            x[k] %= p;
+        }
     }
     else {// p==2 (mod 3)
-        ZZ_pE b;
-        ZZ_pEX g;
+        ZZ_pE g;
+        ZZ_pX f;
+        Vec<ZZ_pE> b;
         ZZ_pPush _p(p.x);
         SetCoeff(f,2);
         SetCoeff(f,1);
         SetCoeff(f,0);
         ZZ_pEPush _f(f);
-        clear(f);
-        conv(c, a.x); SetCoeff(f,0,c);
-        conv(c, a.y); SetCoeff(f,1,c);
-        conv(b,f); negate(b,b);
-        SetCoeff(g,0,b);
-        SetCoeff(g,3);
-        FindRoot(b,g);
-        conv(f,b);
-        conv(x.x, f[0]);
-        conv(x.y, f[1]);
+        sqr(q, p.x);
+        b.SetLength(n);
+        for(k=0; k<n; k++) mod(b[k], a[k]);
+        NonResidue(g,q);
+        CubRoot(b,b,g,q);
+        for(k=0; k<n; k++) {
+            conv(f, b[k]);
+            conv(x[k].x, coeff(f,0));
+            conv(x[k].y, coeff(f,1));
+        }
     }
+}
+
+void CubRootMod(EE& x, const EE& a, const EE& p)
+// solve x^3 == a (mod p)
+// Assume p is primary prime and (a/p)_3 == 1
+// Assume either
+//   norm(p) is prime and norm(p)==1 (mod 3)
+//   or norm(p) is prime^2 and p==2 (mod 3)
+{
+    Vec<EE> b;
+    b.SetLength(1);
+    b[0] = a;
+    CubRootMod(b,b,p);
+    x = b[0];
 }
\ No newline at end of file
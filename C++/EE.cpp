@@ -1,5 +1,11 @@
+#include<NTL/BasicThreadPool.h>
+#include<set>
 #include "EE.h"
 
+#define GENPRIME_MINLEN 24   // shorter primes are generated one by one
+#define GENPRIME_WINDOW 4096 // number of candidates in sieved interval
+#define GENPRIME_SIEVE  4096 // bound of small primes for sieving
+
 std::ostream& operator<<(std::ostream& s, const EE& a) {// output a to s
     s << '[' << a.x << ' ' << a.y << ']';
     return s;
@@ -129,6 +135,24 @@ long FirstHex(EE& b, const EE& a)
     return k;
 }
 
+void EEPrep::prepare()
+// primary(a) is meaningless but harmless if norm(a)==0 (mod 3)
+{
+    ::norm(n,a);
+    h = ::hexant(a);
+    rot60(f, a, h>0 ? 6-h : 0);
+    ::primary(p,a);
+}
+
+long IsAssoc(const EEPrep& a, const EEPrep& b)
+{ return a.first() == b.first(); }
+
+size_t EEAssocHash::operator()(const EEPrep& a) const {
+    const EE& b(a.first());
+    return (size_t)trunc_long(b.x, NTL_BITS_PER_LONG)*0x9e3779b97f4a7c15UL
+         ^ (size_t)trunc_long(b.y, NTL_BITS_PER_LONG);
+}
+
 void add(EE& c, const EE& a, const EE& b) {// c=a+b
     add(c.x, a.x, b.x);
     add(c.y, a.y, b.y);
@@ -160,12 +184,10 @@ void sqr(EE& b, const EE& a) {// b=a*a
     mul(b.y, a.y, t);
 }
 
-void div(EE& q, const EE& a, const EE& b)
-// q = quotient of a/b such that
-//     a = bq + r and norm(r) <= (3/4)norm(b)
+static void ratio(ZZ& n, EE& c, const EE& a, const EE& b, const EEPrep *P)
+// a/b = c/n where n is real
+// P = prepared b if any, whose norm is used
 {
-    ZZ n;
-    EE c;
     if(IsZero(b.y)) {
         n = b.x;
         c = a;
@@ -179,10 +201,19 @@ void div(EE& q, const EE& a, const EE& b)
         rot120(c,a);
     }
     else {
-        norm(n,b);
+        if(P) n = P->norm(); else norm(n,b);
         conj(c,b);
         c *= a;
     }
+}
+
+static void div(EE& q, const EE& a, const EE& b, const EEPrep *P)
+// q = quotient of a/b such that
+//     a = bq + r and norm(r) <= (3/4)norm(b)
+{
+    ZZ n;
+    EE c;
+    ratio(n,c,a,b,P);
     c.x <<= 1; c.x += n;
     c.y <<= 1; c.y += n;
     n <<= 1;
@@ -190,6 +221,9 @@ void div(EE& q, const EE& a, const EE& b)
     div(q.y, c.y, n);
 }
 
+void div(EE& q, const EE& a, const EE& b) { div(q,a,b,0); }
+void div(EE& q, const EE& a, const EEPrep& b) { div(q,a,b,&b); }
+
 void rem(EE& r, const EE& a, const EE& b)
 // r = remainder of a/b such that
 //     a = bq + r and norm(r) <= (3/4)norm(b)
@@ -217,36 +251,161 @@ void DivRem(EE& q, EE& r, const EE& a, const EE& b)
     sub(r,a,r);
 }
 
-long divide(EE& q, const EE& a, const EE& b)
-// if a/b is divisible, set q=a/b and return 1
-// else return 0 and q is unchanged
+void rem(EE& r, const EE& a, const EEPrep& b)
+{ EE q; DivRem(q,r,a,b); }
+
+void DivRem(EE& q, EE& r, const EE& a, const EEPrep& b) {
+    if(&a==&q || &a==&r) {
+        EE c(a);
+        DivRem(q,r,c,b);
+        return;
+    }
+    div(q,a,b);
+    mul(r,b,q);
+    sub(r,a,r);
+}
+
+static void init(EEReducer& R, const EEPrep *P)
+// set up R for R.b; P = prepared b if any, whose norm is used
 {
-    ZZ n;
-    EE c;
-    if(IsZero(b.y)) {
-        n = b.x;
-        c = a;
+    ZZ s,t,N;
+    const EE& b(R.b);
+    if(IsZero(b)) Error("EEReducer: division by zero");
+    if(IsZero(b.y)) { R.mode=0; R.n = b.x; set(R.c); }
+    else if(IsZero(b.x)) { R.mode=1; negate(R.n, b.y); set(R.c,1,1); }
+    else if(b.x == b.y) { R.mode=2; negate(R.n, b.x); set(R.c,0,1); }
+    else {
+        R.mode=3;
+        if(P) R.n = P->norm(); else norm(R.n,b);
+        conj(R.c,b);
     }
-    else if(IsZero(b.x)) {
-        negate(n, b.y);
-        rot60(c,a);
+    LeftShift(R.d, abs(R.n), 1);
+    R.k = NumBits(R.d);
+    power2(R.m, 2*R.k);
+    R.m /= R.d;
+    if(!R.canonical) return;
+    // lattice bZ[w] is generated by b and bw = -b.y + (b.x-b.y)w
+    XGCD(R.D, s, t, b.y, b.x - b.y);
+    if(P) N = P->norm(); else norm(N,b);
+    R.A = N/R.D;
+    conj(R.qA, b);
+    R.qA.x /= R.D;
+    R.qA.y /= R.D;
+    set(R.qC, s, t);
+    mul(R.C, s, b.x); MulSubFrom(R.C, t, b.y);
+    div(s, R.C, R.A);// reduce C mod A
+    MulSubFrom(R.C, s, R.A);
+    MulSubFrom(R.qC.x, s, R.qA.x);
+    MulSubFrom(R.qC.y, s, R.qA.y);
+}
+
+EEReducer::EEReducer(const EE& b_, long canonical_)
+: b(b_), canonical(canonical_) { init(*this, 0); }
+
+EEReducer::EEReducer(const EEPrep& b_, long canonical_)
+: b(b_), canonical(canonical_) { init(*this, &b_); }
+
+static void quot(ZZ& q, const ZZ& a, const EEReducer& R)
+// q = floor(a/R.d) by Barrett reduction if |a| < 2^{2k}
+{
+    ZZ t,u;
+    long s(sign(a)<0);
+    if(s) { negate(t,a); t--; }// floor(a/d) = -floor((-a-1)/d)-1
+    else t=a;
+    if(NumBits(t) > 2*R.k) div(q, t, R.d);
+    else {
+        RightShift(q, t, R.k-1);
+        q *= R.m;
+        q >>= R.k+1;
+        mul(u, q, R.d);
+        t -= u;
+        while(t >= R.d) { t -= R.d; q++; }
     }
-    else if(b.x == b.y) {
-        negate(n, b.x);
-        rot120(c,a);
+    if(s) { negate(q,q); q--; }
+}
+
+void div(EE& q, const EE& a, const EEReducer& R)
+// q = quotient of a/R.b such that
+//     a = bq + r and norm(r) <= (3/4)norm(b)
+{
+    EE c;
+    if(R.mode==0) c=a;
+    else if(R.mode==1) rot60(c,a);
+    else if(R.mode==2) rot120(c,a);
+    else mul(c, R.c, a);
+    c.x <<= 1; c.y <<= 1;
+    if(sign(R.n)>0) { c.x += R.d>>1; c.y += R.d>>1; }
+    else { c.x -= R.d>>1; c.y -= R.d>>1; negate(c,c); }
+    quot(q.x, c.x, R);
+    quot(q.y, c.y, R);
+}
+
+static void CanonicalRem(EE& q, EE& r, const EEReducer& R)
+// r = canonical representative of r mod R.b, q is adjusted
+{
+    ZZ k;
+    div(k, r.y, R.D);
+    if(!IsZero(k)) {
+        MulSubFrom(r.x, k, R.C);
+        MulSubFrom(r.y, k, R.D);
+        MulAddTo(q.x, k, R.qC.x);
+        MulAddTo(q.y, k, R.qC.y);
     }
-    else {
-        norm(n,b);
-        conj(c,b);
-        c *= a;
+    div(k, r.x, R.A);
+    if(!IsZero(k)) {
+        MulSubFrom(r.x, k, R.A);
+        MulAddTo(q.x, k, R.qA.x);
+        MulAddTo(q.y, k, R.qA.y);
     }
+}
+
+void DivRem(EE& q, EE& r, const EE& a, const EEReducer& R) {
+    if(&a==&q || &a==&r) {
+        EE c(a);
+        DivRem(q,r,c,R);
+        return;
+    }
+    div(q,a,R);
+    mul(r,R.b,q);
+    sub(r,a,r);
+    if(R.canonical) CanonicalRem(q,r,R);
+}
+
+void rem(EE& r, const EE& a, const EEReducer& R)
+{ EE q; DivRem(q,r,a,R); }
+
+void rem(Vec<EE>& r, const Vec<EE>& a, const EEReducer& R) {
+    r.SetLength(a.length());
+    NTL_EXEC_RANGE(a.length(), first, last)
+    for(long i=first; i<last; i++) rem(r[i], a[i], R);
+    NTL_EXEC_RANGE_END
+}
+
+void DivRem(Vec<EE>& q, Vec<EE>& r, const Vec<EE>& a, const EEReducer& R) {
+    q.SetLength(a.length());
+    r.SetLength(a.length());
+    NTL_EXEC_RANGE(a.length(), first, last)
+    for(long i=first; i<last; i++) DivRem(q[i], r[i], a[i], R);
+    NTL_EXEC_RANGE_END
+}
+
+static long divide(EE& q, const EE& a, const EE& b, const EEPrep *P)
+// if a/b is divisible, set q=a/b and return 1
+// else return 0 and q is unchanged
+{
+    ZZ n;
+    EE c;
+    ratio(n,c,a,b,P);
     if(!divide(c.x, c.x, n) ||
        !divide(q.y, c.y, n)) return 0;
     q.x = c.x;
     return 1;
 }
 
-long divide(const EE& a, const EE& b)
+long divide(EE& q, const EE& a, const EE& b) { return divide(q,a,b,0); }
+long divide(EE& q, const EE& a, const EEPrep& b) { return divide(q,a,b,&b); }
+
+static long divide(const EE& a, const EE& b, const EEPrep *P)
 // if a/b is divisible, return 1, else return 0
 {
     ZZ n;
@@ -255,12 +414,15 @@ long divide(const EE& a, const EE& b)
         return divide(a.x, b.x) && divide(a.y, b.x);
     else if(IsZero(b.x))
         return divide(a.x, b.y) && divide(a.y, b.y);
-    norm(n,b);
+    if(P) n = P->norm(); else norm(n,b);
     conj(c,b);
     c *= a;
     return divide(c.x, n) && divide(c.y, n);
 }
 
+long divide(const EE& a, const EE& b) { return divide(a,b,0); }
+long divide(const EE& a, const EEPrep& b) { return divide(a,b,&b); }
+
 long divide3(EE& q, const EE& a)
 // if a is divisible by 1-w, set q=a/(1-w) and return 1
 // else return 0 and q is unchanged
@@ -346,6 +508,120 @@ void XGCD(EE& d, EE& s, EE& t, const EE& a, const EE& b)
     rot60(t,t,k);
 }
 
+template<class M>
+static long InvModStatus_(EE& b, const EE& a, const M& m)
+// if a is invertible mod m, set b = a^{-1} mod m and return 0
+// else set b = GCD(a,m) and return 1
+// by extended euclidean algorithm, keeping track of s only
+// M = EE or EEPrep, by which first and last divisions are done
+{
+    long k;
+    EE x(m),y,s,u(1),q,r;
+    rem(y,a,m);
+    while(!IsZero(y)) {
+        DivRem(q,r,x,y);
+        q *= u;
+        sub(q,s,q);
+        std::swap(s,u);
+        std::swap(u,q);
+        std::swap(x,y);
+        std::swap(y,r);
+    }
+    k = FirstHex(x,x);
+    if(!IsOne(x)) { b=x; return 1; }
+    rot60(s,s,k);
+    rem(b,s,m);
+    return 0;
+}
+
+long InvModStatus(EE& b, const EE& a, const EE& m)
+{ return InvModStatus_(b,a,m); }
+
+long InvModStatus(EE& b, const EE& a, const EEPrep& m)
+{ return InvModStatus_(b,a,m); }
+
+void InvMod(EE& b, const EE& a, const EE& m)
+// b = a^{-1} mod m; Error if a is not invertible
+{
+    if(InvModStatus(b,a,m)) Error("InvMod: inverse undefined");
+}
+
+void InvMod(EE& b, const EE& a, const EEPrep& m)
+{
+    if(InvModStatus(b,a,m)) Error("InvMod: inverse undefined");
+}
+
+template<class M>
+static void InvMod_(Vec<EE>& b, const Vec<EE>& a, const M& m)
+// b[i] = a[i]^{-1} mod m for i=0,...,a.length()-1
+// by Montgomery's trick, i.e., one inversion of product of a[i]
+// and 3(n-1) multiplications; Error if any a[i] is not invertible
+{
+    long i,n(a.length());
+    EE t,u;
+    Vec<EE> c;
+    c.SetLength(n);
+    b.SetLength(n);
+    if(n==0) return;
+    rem(c[0], a[0], m);
+    for(i=1; i<n; i++) {// c[i] = a[0]...a[i] mod m
+        mul(t, c[i-1], a[i]);
+        rem(c[i], t, m);
+    }
+    InvMod(t, c[n-1], m);
+    for(i=n-1; i>0; i--) {// t = (a[0]...a[i])^{-1} mod m
+        mul(u, t, a[i]);
+        mul(c[i], t, c[i-1]);
+        rem(b[i], c[i], m);
+        rem(t, u, m);
+    }
+    b[0] = t;
+}
+
+void InvMod(Vec<EE>& b, const Vec<EE>& a, const EE& m) { InvMod_(b,a,m); }
+void InvMod(Vec<EE>& b, const Vec<EE>& a, const EEPrep& m) { InvMod_(b,a,m); }
+
+void CRT(EE& a, EE& p, const EE& A, const EE& P)
+// set a,p such that a == a (mod p), a == A (mod P) and p = p*P
+// Assume p and P are relatively prime
+{
+    EE t,u;
+    rem(u,p,P);
+    InvMod(t,u,P);
+    sub(u,A,a);
+    u *= t;
+    rem(u,u,P);
+    u *= p;
+    a += u;
+    p *= P;
+    rem(a,a,p);
+}
+
+void CRT(EE& a, EE& m, const Vec<EE>& r, const Vec<EE>& p)
+// a = x mod m such that x == r[i] (mod p[i]) for all i
+//   and m = product of p[i]
+// Assume p[i] are pairwise relatively prime
+// residues are combined pairwise by balanced tree in parallel
+{
+    long i,n(r.length());
+    Vec<EE> x(r), y(p);
+    if(n != p.length()) Error("CRT: length mismatch");
+    if(n==0) { clear(a); set(m); return; }
+    for(i=0; i<n; i++) rem(x[i], x[i], y[i]);
+    for(; n>1; n=(n+1)>>1) {
+        NTL_EXEC_RANGE(n>>1, first, last)
+        for(long j=first; j<last; j++)
+            CRT(x[2*j], y[2*j], x[2*j+1], y[2*j+1]);
+        NTL_EXEC_RANGE_END
+        for(i=1; 2*i<n; i++) {
+            std::swap(x[i], x[2*i]);
+            std::swap(y[i], y[2*i]);
+        }
+    }
+    std::swap(a, x[0]);
+    std::swap(m, y[0]);
+}
+
 // b = random Eisenstein integer in hexagon R*e^{i\pi n/3} (n=0...5)
 void RandomBits(EE& b, long l)// 0 <= R < 2^l
 { RandomBits(b.x, l); RandomBits(b.y, l); rot60(b, b, RandomBnd(3)<<1); }
@@ -356,49 +632,136 @@ void RandomLen(EE& b, long l)// 2^{l-1} <= R < 2^l
 void RandomBnd(EE& b, const ZZ& a)// 0 <= R < a
 { RandomBnd(b.x, a); RandomBnd(b.y, a); rot60(b, b, RandomBnd(3)<<1); }
 
-void PowerMod(EE& b, const EE& a, long n, const EE& m)
+template<class F>
+static void RandomHex(Vec<EE>& b, long n, long k, F f)
+// b = n random Eisenstein integers from one draw of n(2k+4) bytes
+// f(x,p) sets x from k bytes p for each of b[i].x, b[i].y
+// and b[i] is rotated by u%3 where u is from 4 bytes;
+// if u = 2^32-1, the rotation is drawn again afterwards
+{
+    long i,m(2*k+4);
+    Vec<unsigned char> s;
+    Vec<char> r;
+    b.SetLength(n);
+    s.SetLength(n*m);
+    r.SetLength(n);
+    GetCurrentRandomStream().get(s.elts(), s.length());
+    NTL_EXEC_RANGE(n, first, last)
+    for(long j=first; j<last; j++) {
+        const unsigned char *p(s.elts() + j*m);
+        unsigned long u(0);
+        f(b[j].x, p);
+        f(b[j].y, p+k);
+        for(long t=3; t>=0; t--) u = u<<8 | p[2*k+t];
+        if(u == 0xffffffffUL) r[j] = 1;
+        else { r[j] = 0; rot60(b[j], b[j], (u%3)<<1); }
+    }
+    NTL_EXEC_RANGE_END
+    for(i=0; i<n; i++)
+        if(r[i]) rot60(b[i], b[i], RandomBnd(3)<<1);
+}
+
+void RandomBits(Vec<EE>& b, long n, long l) {
+    if(l<0) l=0;
+    long k((l+7)>>3);
+    RandomHex(b, n, k, [k,l](ZZ& x, const unsigned char *p) {
+        ZZFromBytes(x,p,k);
+        trunc(x,x,l);
+    });
+}
+
+void RandomLen(Vec<EE>& b, long n, long l) {
+    if(l<=0) { RandomBits(b,n,0); return; }
+    long k((l+7)>>3);
+    RandomHex(b, n, k, [k,l](ZZ& x, const unsigned char *p) {
+        ZZFromBytes(x,p,k);
+        trunc(x,x,l-1);
+        SetBit(x,l-1);
+    });
+}
+
+void RandomBnd(Vec<EE>& b, long n, const ZZ& a) {
+    if(a<=0) { RandomBits(b,n,0); return; }
+    long k((NumBits(a)+64+7)>>3);
+    RandomHex(b, n, k, [k,&a](ZZ& x, const unsigned char *p) {
+        ZZFromBytes(x,p,k);
+        rem(x,x,a);
+    });
+}
+
+void SetSeed(const ZZ& s, long i)
+// seed of NTL's generator = (i, sign of s, bytes of |s|)
+{
+    long j,k(NumBytes(s));
+    Vec<unsigned char> b;
+    b.SetLength(k+9);
+    for(j=0; j<8; j++) b[j] = (unsigned long)i >> (j<<3);
+    b[8] = sign(s) < 0;
+    BytesFromZZ(b.elts()+9, abs(s), k);
+    NTL::SetSeed(b.elts(), b.length());
+}
+
+template<class M>
+static void PowerMod_(EE& b, const EE& a, long n, const M& m)
 // b = a^n mod m; assume n>=0 and |a| < |m|
 {
     if(n==0 || IsOne(a)) { set(b); return; }
-    if(&b==&a) { EE c(a); PowerMod(b,c,n,m); return; }
+    if(&b==&a) { EE c(a); PowerMod_(b,c,n,m); return; }
     long k(1<<(NumBits(n)-1));
+    EEReducer R(m);
     b=a;
     for(k>>=1; k; k>>=1) {
-        sqr(b,b); b%=m;
-        if(n&k) { b*=a; b%=m; }
+        sqr(b,b); rem(b,b,R);
+        if(n&k) { b*=a; rem(b,b,R); }
     }
 }
 
-void PowerMod(EE& b, const EE& a, const ZZ& n, const EE& m)
+template<class M>
+static void PowerMod_(EE& b, const EE& a, const ZZ& n, const M& m)
 // b = a^n mod m; assume n>=0 and norm(a) < norm(m)
 {
     if(IsZero(n) || IsOne(a)) { set(b); return; }
-    if(&b==&a) { EE c(a); PowerMod(b,c,n,m); return; }
+    if(&b==&a) { EE c(a); PowerMod_(b,c,n,m); return; }
+    EEReducer R(m);
     b=a;
     for(long k=NumBits(n)-2; k>=0; k--) {
-        sqr(b,b); b%=m;
-        if(bit(n,k)) { b*=a; b%=m; }
+        sqr(b,b); rem(b,b,R);
+        if(bit(n,k)) { b*=a; rem(b,b,R); }
     }
 }
 
-long ProbPrime(const EE& a, long NTRY)
+void PowerMod(EE& b, const EE& a, long n, const EE& m)
+{ PowerMod_(b,a,n,m); }
+
+void PowerMod(EE& b, const EE& a, long n, const EEPrep& m)
+{ PowerMod_(b,a,n,m); }
+
+void PowerMod(EE& b, const EE& a, const ZZ& n, const EE& m)
+{ PowerMod_(b,a,n,m); }
+
+void PowerMod(EE& b, const EE& a, const ZZ& n, const EEPrep& m)
+{ PowerMod_(b,a,n,m); }
+
+static long ProbPrime(const EE& a, long NTRY, const EEPrep *P)
 // return 1 if either
 //   |a| is prime and |a|==2 (mod 3) or
 //   norm(a) is prime and norm(a)==1 (mod 3) or
 //   norm(a) == 3
 // else return 0
-// NTRY: number of trials of Miller-Rabin test
-// primality is tested probabilistically MR method
+// primality is tested by BPSW and NTRY trials of Miller-Rabin test
 {
     ZZ b;
     if(IsZero(a.y) || a.x==a.y) abs(b, a.x);
     else if(IsZero(a.x)) abs(b, a.y);
     if(!IsZero(b))
-        return b%3 == 2 && ProbPrime(b, NTRY);
-    norm(b,a);
-    return b==3 || b%3 == 1 && ProbPrime(b, NTRY);
+        return b%3 == 2 && BPSW(b) && (NTRY<=0 || ProbPrime(b, NTRY));
+    if(P) b = P->norm(); else norm(b,a);
+    return b==3 || b%3 == 1 && BPSW(b) && (NTRY<=0 || ProbPrime(b, NTRY));
 }
 
+long ProbPrime(const EE& a, long NTRY) { return ProbPrime(a,NTRY,0); }
+long ProbPrime(const EEPrep& a, long NTRY) { return ProbPrime(a,NTRY,&a); }
+
 void GenPrime(EE& p, long l, long f, long err)
 // generate random Eisenstein prime p
 // Assume f=1 or 2; Assume l>=2
@@ -407,10 +770,16 @@ void GenPrime(EE& p, long l, long f, long err)
 // where q is random prime and 2^{l-1} <= q < 2^l
 // probability of error is less than 2^-err
 // p is primary, i.e., p.x==2 and p.y==0 (mod 3)
+// if l > GENPRIME_MINLEN, q is found by sieve and BPSW (GenPrime below)
 {
     if(l<2) Error("l<2 in GenPrime");
     ZZ q;
-    if(f==1) {
+    if(l > GENPRIME_MINLEN && (f==1 || f==2)) {
+        Vec<EE> v;
+        GenPrime(v,1,l,f,err);
+        p = v[0];
+    }
+    else if(f==1) {
         do GenPrime(q,l,err);
         while(q%3 == 2);
         if(q==3) { set(p,1,-1); return; }
@@ -425,6 +794,94 @@ void GenPrime(EE& p, long l, long f, long err)
     else Error("f<1 or f>2 in GenPrime");
 }
 
+static long GenPrimeWindow(ZZ& q, const ZZ& q0, long err, const Vec<long>& sp,
+                           RandomStream& rs)
+// q = random prime in window q0 + 6i (0 <= i < GENPRIME_WINDOW)
+// candidates sieved by primes sp are tested by BPSW in random order,
+//   so that q is uniformly distributed over primes in the window,
+//   and q is confirmed by MR test with error less than 2^-err
+// return 1 if found, else 0
+{
+    long i,j,t;
+    unsigned long u;
+    Vec<char> sv;
+    Vec<long> c;
+    sv.SetLength(GENPRIME_WINDOW);
+    for(i=0; i<GENPRIME_WINDOW; i++) sv[i] = 1;
+    for(j=0; j<sp.length(); j++) {
+        t = MulMod((sp[j] - q0%sp[j])%sp[j], InvMod(6%sp[j], sp[j]), sp[j]);
+        for(i=t; i<GENPRIME_WINDOW; i+=sp[j]) sv[i] = 0;
+    }
+    for(i=0; i<GENPRIME_WINDOW; i++) if(sv[i]) c.append(i);
+    for(i=c.length(); i>0; i--) {// Fisher-Yates shuffle on the fly
+        rs.get((unsigned char *)&u, sizeof(u));
+        j = u%i;
+        conv(q, 6*c[j]);
+        q += q0;
+        if(BPSW(q) && ProbPrime(q, (err+1)>>1)) return 1;
+        c[j] = c[i-1];
+    }
+    return 0;
+}
+
+void GenPrime(Vec<EE>& p, long n, long l, long f, long err)
+// generate n random Eisenstein primes p[0],...,p[n-1]
+// with the same conditions on l,f,err as GenPrime above
+// each prime q is taken from its own random window
+//   q0 + 6i (0 <= i < GENPRIME_WINDOW), q0==1 (if f=1) or 5 (if f=2)
+//   mod 6, and windows are searched in parallel;
+//   duplicates are rejected; if f=1, q are split by FactorPrime together
+// windows and their orders of search are drawn from the random stream
+//   of the calling thread, so that p does not depend on scheduling
+{
+    if(l<2) Error("l<2 in GenPrime");
+    if(f<1 || f>2) Error("f<1 or f>2 in GenPrime");
+    long i,j,k(0),m,s;
+    p.SetLength(n);
+    if(l <= GENPRIME_MINLEN) {
+        for(i=0; i<n; i++) GenPrime(p[i], l, f, err);
+        return;
+    }
+    ZZ b;
+    Vec<ZZ> c,q,q0;
+    Vec<long> r,sp;
+    Vec<Vec<unsigned char> > key;
+    std::set<ZZ> S;
+    PrimeSeq ps;
+    ps.reset(5);
+    while((s = ps.next()) <= GENPRIME_SIEVE) sp.append(s);
+    q.SetLength(n);
+    power2(b, l-1);
+    while(k<n) {
+        m = n-k;
+        q0.SetLength(m);
+        key.SetLength(m);
+        for(j=0; j<m; j++) {
+            RandomBnd(q0[j], b - 6*GENPRIME_WINDOW);
+            q0[j] += b;
+            q0[j] += ((f==1 ? 1:5) + 6 - q0[j]%6)%6;
+            key[j].SetLength(NTL_PRG_KEYLEN);
+            GetCurrentRandomStream().get(key[j].elts(), NTL_PRG_KEYLEN);
+        }
+        c.SetLength(m);
+        r.SetLength(m);
+        NTL_EXEC_RANGE(m, first, last)
+        for(long t=first; t<last; t++) {
+            RandomStream rs(key[t].elts());
+            r[t] = GenPrimeWindow(c[t], q0[t], err, sp, rs);
+        }
+        NTL_EXEC_RANGE_END
+        for(j=0; j<m; j++)
+            if(r[j] && S.insert(c[j]).second) q[k++] = c[j];
+    }
+    if(f==1) {
+        FactorPrime(p,q);
+        for(i=0; i<n; i++)
+            if(RandomBits_long(1)) conj(p[i], p[i]);
+    }
+    else for(i=0; i<n; i++) conv(p[i], q[i]);
+}
+
 long primary(EE& b, const EE& a)
 // b = unit * a such that b.x==2 and b.y==0 (mod 3)
 // return k=0,1,2 such that a = \pm omega^k * b
@@ -446,16 +903,19 @@ long primary(EE& b, const EE& a)
     return 0;
 }
 
-void ResSymb(EE& s, const EE& a, const EE& b)
+static void ResSymb(EE& s, const EE& a, const EE& b, const EEPrep *P)
 // s = cubic residue symbol (a/b)_3 = 0,1,w,w^2
 // Assume norm(a) < norm(b) and norm(b) != 0 (mod 3)
 // Assume b is primary, but may not be prime
+// P = prepared associate of b if any, by which a is first reduced
+//     using its cached norm, so that norm(a) may be large
 // reference: K. Ireland and M. Rosen
 //   "A Classical Introduction to Modern Number Theory" section 9.3
 {
     long i,j(0),m,n;
     ZZ M,N;
-    EE u(a),v(b),w;
+    EE u,v(b),w;
+    if(P) rem(u,a,*P); else u=a;
     while(!IsZero(u)) {
         DivRem(M, v.x, 3); M++;
         DivRem(N, v.y, 3);
@@ -473,4 +933,118 @@ void ResSymb(EE& s, const EE& a, const EE& b)
     else if(j==0) set(s);
     else if(j==1) set(s,0,1);
     else set(s,-1,-1);
-}
\ No newline at end of file
+}
+
+void ResSymb(EE& s, const EE& a, const EE& b) { ResSymb(s,a,b,0); }
+void ResSymb(EE& s, const EE& a, const EEPrep& b)
+{ ResSymb(s, a, b.primary(), &b); }
+
+static long mod3(long a) { a%=3; return a<0 ? a+3 : a; }
+static long div3(long a) { return a>=0 ? a/3 : -((2-a)/3); }// floor(a/3)
+
+static __int128 FloorDiv(__int128 a, __int128 b)// floor(a/b); assume b>0
+{ return a>=0 ? a/b : -((b-1-a)/b); }
+
+static void rem(long& rx, long& ry, long ax, long ay, long bx, long by)
+// r = a%b, word size version of rem(EE&, const EE&, const EE&)
+// intermediates are < 2^127 if |ax|,|ay|,|bx|,|by| < 2^62
+{
+    __int128 n((__int128)bx*bx - (__int128)bx*by + (__int128)by*by);
+    long c(bx-by), d(-by);// conj(b)
+    __int128 cx((__int128)ax*c - (__int128)ay*d);
+    __int128 cy((__int128)ax*d + (__int128)ay*c - (__int128)ay*d);
+    long qx(FloorDiv(2*cx+n, 2*n)), qy(FloorDiv(2*cy+n, 2*n));
+    rx = ax - (bx*qx - by*qy);
+    ry = ay - (bx*qy + by*qx - by*qy);
+}
+
+static long divide3(long& x, long& y)
+// if x+yw is divisible by 1-w, set x+yw /= 1-w and return 1
+{
+    if(mod3(x+y)) return 0;
+    long t((2*x-y)/3);
+    y = (x+y)/3;
+    x = t;
+    return 1;
+}
+
+static long primary(long& x, long& y)
+// word size version of primary(EE&, const EE&)
+{
+    long t,a(mod3(x)), b(mod3(y));
+    if(a==b) { t=x; x=-y; y=t-y; }// *w
+    else if(a==0) { t=x; x-=y; y=t; }// *(1+w)
+    if(a==b || a==0) {
+        if(b==2) { x=-x; y=-y; }
+        return a==b ? 2:1;
+    }
+    if(a==1) { x=-x; y=-y; }
+    return 0;
+}
+
+static long IsCubicResidue(long t, long x, long y)
+// return 1 if (t/p)_3 == 0,1 where p = x+yw is primary prime
+// by cubic reciprocity in word size as ResSymb; Assume 0 <= t < norm(p)
+{
+    long i,j(0),m,n,ux(t),uy(0),vx(x),vy(y),wx,wy;
+    while(ux || uy) {
+        m = mod3(div3(vx)+1);
+        n = (mod3(div3(vy)) + m)%3;
+        while(divide3(ux,uy)) j = (j+3-m)%3;
+        for(i=primary(ux,uy); i; i--) j = (j+n)%3;
+        rem(wx,wy,vx,vy,ux,uy);
+        vx = ux; vy = uy;
+        ux = wx; uy = wy;
+    }
+    if(!(vy==0 && (vx==1 || vx==-1)) &&
+       !((vy==1 || vy==-1) && (vx==0 || vx==vy))) return 1;// not unit
+    return j==0;
+}
+
+static long IsCubicResidue(const ZZ& a, const ZZ& q, const EE& p)
+// p = primary prime of norm q if q==1 (mod 3)
+// word size reciprocity if q < NTL_SP_BOUND
+{
+    ZZ t;
+    EE b,s;
+    if(q%3 != 1) return 1;
+    rem(t,a,q);
+    if(q < NTL_SP_BOUND)
+        return IsCubicResidue(to_long(t), to_long(p.x), to_long(p.y));
+    rem(b,EE(t),p);
+    ResSymb(s,b,p,0);
+    return IsZero(s.y);
+}
+
+long IsCubicResidue(const ZZ& a, const ZZ& q)
+// (a/p)_3 == 1 iff a is cube in Z[w]/(p) = Z/(q)
+{
+    EE p;
+    if(q%3 == 1) FactorPrime(p,q);
+    return IsCubicResidue(a,q,p);
+}
+
+void CubicSplits(Vec<EE>& p, const Vec<ZZ>& q) {
+    p.SetLength(q.length());
+    NTL_EXEC_RANGE(q.length(), first, last)
+    for(long i=first; i<last; i++) {
+        if(q[i]%3 == 1) FactorPrime(p[i], q[i]);
+        else clear(p[i]);
+    }
+    NTL_EXEC_RANGE_END
+}
+
+void IsCubicResidue(Vec<long>& r, const ZZ& a, const Vec<ZZ>& q,
+                    const Vec<EE>& p) {
+    if(p.length() != q.length()) Error("IsCubicResidue: length mismatch");
+    r.SetLength(q.length());
+    NTL_EXEC_RANGE(q.length(), first, last)
+    for(long i=first; i<last; i++) r[i] = IsCubicResidue(a, q[i], p[i]);
+    NTL_EXEC_RANGE_END
+}
+
+void IsCubicResidue(Vec<long>& r, const ZZ& a, const Vec<ZZ>& q) {
+    Vec<EE> p;
+    CubicSplits(p,q);
+    IsCubicResidue(r,a,q,p);
+}
@@ -2,6 +2,8 @@
 #define __EE_h__
 
 #include<NTL/ZZ.h>
+#include<NTL/vector.h>
+#include<functional>
 using namespace NTL;
 
 struct EE {
@@ -64,6 +66,91 @@ void div(EE& q, const EE& a, const EE& b);// q=a/b
 void rem(EE& r, const EE& a, const EE& b);// r=a%b, norm(r) < norm(b)
 void DivRem(EE& q, EE& r, const EE& a, const EE& b);// q=a/b, r=a%b
 
+class EEPrep {
+    // Eisenstein integer with its norm, hexant, first hexant associate
+    // and primary form, computed at construction and assignment
+    // for long-lived moduli, divisors and primes
+    // const EEPrep is never written, so it can be shared by threads
+    EE a;
+    ZZ n;// norm(a)
+    long h;// hexant(a)
+    EE f;// FirstHex(a)
+    EE p;// primary(a)
+    void prepare();
+public:
+    EEPrep() { prepare(); }// a=0
+    explicit EEPrep(const EE& b) : a(b) { prepare(); }// a=b
+    EEPrep& operator=(const EE& b) { a=b; prepare(); return *this; }
+    operator const EE&() const { return a; }
+    const EE& value() const { return a; }
+    const ZZ& norm() const { return n; }
+    long hexant() const { return h; }
+    const EE& first() const { return f; }
+    const EE& primary() const { return p; }// Assume norm(a) != 0 (mod 3)
+};
+
+// functions taking modulus or divisor b as EEPrep
+// are the same as those taking EE but use cached entries of b
+void div(EE& q, const EE& a, const EEPrep& b);
+void rem(EE& r, const EE& a, const EEPrep& b);
+void DivRem(EE& q, EE& r, const EE& a, const EEPrep& b);
+long divide(EE& q, const EE& a, const EEPrep& b);
+long divide(const EE& a, const EEPrep& b);
+void PowerMod(EE& b, const EE& a, long n, const EEPrep& m);
+void PowerMod(EE& b, const EE& a, const ZZ& n, const EEPrep& m);
+long InvModStatus(EE& b, const EE& a, const EEPrep& m);
+void InvMod(EE& b, const EE& a, const EEPrep& m);
+void InvMod(Vec<EE>& b, const Vec<EE>& a, const EEPrep& m);
+void ResSymb(EE& s, const EE& a, const EEPrep& b);
+// b need not be primary; a is reduced mod b first, so any a is allowed
+long ProbPrime(const EEPrep& a, long NTRY=0);
+
+long IsAssoc(const EEPrep& a, const EEPrep& b);
+// return 1 if a = b*(1+w)^k for some k=0,1,...,5
+// by comparing cached first hexant associates
+
+struct EEAssocHash {
+    // hash of first hexant associate, equal for associates
+    size_t operator()(const EEPrep& a) const;
+};
+
+struct EEAssocEqual {
+    // equality up to units
+    bool operator()(const EEPrep& a, const EEPrep& b) const
+    { return IsAssoc(a,b); }
+};
+// e.g. std::unordered_set<EEPrep, EEAssocHash, EEAssocEqual>
+//   holds one element of each class of associates
+
+struct EEReducer {
+    // precomputation for division by fixed b != 0
+    // quotient is computed by rounding c*a/n as in div above
+    //   where c = conj(b) or unit and n = norm(b) or real part
+    EE b,c;
+    long mode;// 0: b real, 1: b.x==0, 2: b.x==b.y, 3: otherwise
+    ZZ n;// norm(b) or real part as in div above
+    ZZ d;// |2n|
+    long k;// number of bits of d
+    ZZ m;// Barrett reciprocal floor(2^{2k}/d)
+    long canonical;// if nonzero, remainders are canonical
+    ZZ A,C,D;// HNF of lattice bZ[w] = (A,0)Z + (C,D)Z
+    EE qA,qC;// A = b*qA, C+Dw = b*qC
+    explicit EEReducer(const EE& b, long canonical=0);
+    explicit EEReducer(const EEPrep& b, long canonical=0);// uses cached norm
+};
+
+void div(EE& q, const EE& a, const EEReducer& R);// q=a/R.b
+void rem(EE& r, const EE& a, const EEReducer& R);// r=a%R.b
+void DivRem(EE& q, EE& r, const EE& a, const EEReducer& R);
+// same as div, rem, DivRem above with b = R.b
+// if R.canonical is nonzero, r = x+yw is unique representative
+//   such that 0 <= x < R.A and 0 <= y < R.D (R.A * R.D = norm(b))
+//   which is suitable for hashing residues
+void rem(Vec<EE>& r, const Vec<EE>& a, const EEReducer& R);
+void DivRem(Vec<EE>& q, Vec<EE>& r, const Vec<EE>& a, const EEReducer& R);
+// r[i] = a[i]%R.b (q[i] = a[i]/R.b) for i=0,...,a.length()-1
+// computed in parallel
+
 long divide(EE& q, const EE& a, const EE& b);
 // if a/b is divisible, set q=a/b and return 1
 // else return 0 and q is unchanged
@@ -94,23 +181,64 @@ void XGCD(EE&, EE&, EE&, const EE&, const EE&);
 //     and compute s,t such that d = s*a + t*b
 // by extended euclidean algorithm
 
+long InvModStatus(EE& b, const EE& a, const EE& m);
+// if GCD(a,m)==1, set b = a^{-1} mod m and return 0
+// else set b = GCD(a,m) and return 1
+
+void InvMod(EE& b, const EE& a, const EE& m);
+// b = a^{-1} mod m; Error if GCD(a,m)!=1
+
+void InvMod(Vec<EE>& b, const Vec<EE>& a, const EE& m);
+// b[i] = a[i]^{-1} mod m for i=0,...,a.length()-1
+// by Montgomery's trick with a single inversion
+// Error if any a[i] is not invertible
+
+void CRT(EE& a, EE& p, const EE& A, const EE& P);
+// a = x mod p*P, p = p*P
+//   where x == a (mod p) and x == A (mod P)
+// Assume GCD(p,P)==1
+
+void CRT(EE& a, EE& m, const Vec<EE>& r, const Vec<EE>& p);
+// a = x mod m, m = product of p[i]
+//   where x == r[i] (mod p[i]) for i=0,...,r.length()-1
+// Assume p[i] are pairwise relatively prime
+
 // b = random Eisenstein integer in hexagon R*e^{i\pi n/3} (n=0...5)
 void RandomBits(EE& b, long l);// 0 <= R < 2^l
 void RandomLen(EE& b, long l);// 2^{l-1} <= R < 2^l
 void RandomBnd(EE& b, const ZZ& a);// 0 <= R < a
 
+// b = n random Eisenstein integers distributed as above
+// drawn from the random stream at once and converted in parallel,
+// so that b depends only on the state of the stream
+// RandomBnd has bias less than 2^-64
+void RandomBits(Vec<EE>& b, long n, long l);
+void RandomLen(Vec<EE>& b, long n, long l);
+void RandomBnd(Vec<EE>& b, long n, const ZZ& a);
+
+void SetSeed(const ZZ& s, long i);
+// random stream of the calling thread = i-th stream of seed s
+// streams of distinct (s,i) are independent, so that
+// parallel workers seeded by (s,i) for task i give the same results
+// regardless of scheduling; NTL keeps the stream per thread
+
 void PowerMod(EE& b, const EE& a, long n, const EE& m);
 void PowerMod(EE& b, const EE& a, const ZZ& n, const EE& m);
 // b = a^n mod m; assume n>=0 and norm(a) < norm(m)
 
-long ProbPrime(const EE& a, long NTRY=10);
+long ProbPrime(const EE& a, long NTRY=0);
 // return 1 if either
 //   |a| is prime and |a|==2 (mod 3)
 //   or norm(a) is prime and norm(a)==1 (mod 3)
 //   or norm(a) == 3
 // else return 0
-// NTRY: number of trials of Miller-Rabin test
-// primality is tested probabilistically by MR method
+// primality is tested by BPSW below (deterministic below 2^64)
+// NTRY: number of additional trials of Miller-Rabin test if NTRY>0
+
+long BPSW(const ZZ& n);
+// return 1 if n is probable prime by Baillie-PSW test
+// else return 0
+// if n < 2^64, the test is deterministic
 
 void GenPrime(EE& p, long l, long f=1, long err=80);
 // generate random Eisenstein prime p
@@ -120,6 +248,16 @@ void GenPrime(EE& p, long l, long f=1, long err=80);
 // where q is random prime and 2^{l-1} <= q < 2^l
 // probability of error is less than 2^-err
 // p is primary, i.e., p.x==2 and p.y==0 (mod 3)
+// if l > 24, q is found by sieve and BPSW as in GenPrime(Vec) below
+
+void GenPrime(Vec<EE>& p, long n, long l, long f=1, long err=80);
+// generate n random Eisenstein primes p[0],...,p[n-1]
+// with the same conditions on l,f as GenPrime above
+// each q is a random prime in its own random interval, where
+// candidates sieved by small primes are tested by BPSW in random order
+// and the one found is confirmed by MR test with error < 2^-err;
+// intervals are searched in parallel and duplicates are rejected
+// if f=1, q are split together
 
 long primary(EE& b, const EE& a);
 // b = unit * a such that b.x==2 and b.y==0 (mod 3)
@@ -131,16 +269,74 @@ void ResSymb(EE& s, const EE& a, const EE& b);
 // Assume norm(a) < norm(b) and norm(b) != 0 (mod 3)
 // Assume b is primary, but may not be prime
 
+long IsCubicResidue(const ZZ& a, const ZZ& q);
+// return 1 if x^3 == a (mod q) has a solution, else 0
+//   1 if q==2 (mod 3) or q==3, where every residue is a cube
+//   else 1 iff (a/p)_3 != w,w^2 by cubic reciprocity as ResSymb
+//   (in word size arithmetic if q < NTL_SP_BOUND)
+//   where p is primary prime of norm q (FactorPrime)
+// Assume q is prime
+
+void CubicSplits(Vec<EE>& p, const Vec<ZZ>& q);
+// p[i] = FactorPrime(q[i]) if q[i]==1 (mod 3), else 0
+// computed in parallel; Assume q[i] are prime
+
+void IsCubicResidue(Vec<long>& r, const ZZ& a, const Vec<ZZ>& q);
+void IsCubicResidue(Vec<long>& r, const ZZ& a, const Vec<ZZ>& q,
+                    const Vec<EE>& p);
+// r[i] = IsCubicResidue(a, q[i]) for i=0,...,q.length()-1
+// computed in parallel; p = CubicSplits(q) is computed once
+// and may be reused for many a
+
 void CubRootMod(EE&, const EE&, const EE&);
 // solve x^3 == a (mod p)
 // Assume p is primary prime and (a/p)_3 == 1
 // Assume either
 //   norm(p) is prime and norm(p)==1 (mod 3)
 //   or norm(p) is prime^2 and p==2 (mod 3)
+// by Adleman-Manders-Miller algorithm in Z[w]/(p)
+
+void CubRootMod(Vec<EE>& x, const Vec<EE>& a, const EE& p);
+// solve x[k]^3 == a[k] (mod p) for k=0,...,a.length()-1
+// with the same assumptions as above
+// modulus context and cubic non-residue are set up once
 
 void FactorPrime(EE& f, const ZZ& p);
 // find x,y such that x^2 - xy + y^2 = p and x==2, y==0 (mod 3)
 // Assume p is prime and p==1 (mod 3)
 // return f = x+wy
 
+void FactorPrime(Vec<EE>& f, const Vec<ZZ>& p);
+// f[i] = FactorPrime(p[i]) for i=0,...,p.length()-1
+// computed in parallel
+
+void FactorPrime(long& x, long& y, long p);
+// word-size version of FactorPrime above
+// Assume p is prime, p==1 (mod 3) and p < 2^62
+
+void EEPrimes(long N, const std::function<void(long, long)>& f);
+// call f(x,y) for every primary prime x+yw with norm <= N
+//   i.e., 1-w, split primes of prime norm p==1 (mod 3)
+//   and rational primes q==2 (mod 3) with q^2 <= N
+// in increasing order of norm; each split prime is
+// followed by its conjugate; Assume N < 2^62
+// rational primes are sieved by segments in parallel
+
+void EEPrimes(Vec<EE>& p, long N);
+// p = primary primes with norm <= N in the order of EEPrimes above
+
+void TraceFrob(ZZ& a, const ZZ& D, const ZZ& p);
+// a = p + 1 - #E(F_p) for elliptic curve E: y^2 = x^3 + D
+//   = -Tr(conj((4D/pi)_6) pi) if p==1 (mod 3)
+//     where pi is primary prime of norm p (FactorPrime)
+//     and (a/pi)_6 = a^{(p-1)/6} mod pi is sextic residue symbol
+//   = 0 if p==2 (mod 3) or p divides D
+// Assume p is prime and p>3
+
+void TraceFrob(const ZZ& D, long P0, long P1,
+               const std::function<void(long, long)>& f);
+// call f(p, a) for every prime p, P0 <= p < P1 (p>3)
+// in increasing order, where a = TraceFrob(D,p) as above
+// Assume P1 <= NTL_SP_BOUND
+
 #endif // __EE_h__
\ No newline at end of file
@@ -1,6 +1,7 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
+#include<NTL/BasicThreadPool.h>
 #include "EEFactoring.h"
 using namespace NTL;
 
@@ -38,7 +39,17 @@ void FactorPrime(EE& f, const ZZ& p)
     primary(f,f);
 }
 
-void factor(Vec<Pair<EE, long> >& f, const EE& a)
+void FactorPrime(Vec<EE>& f, const Vec<ZZ>& p)
+// f[i] = FactorPrime(p[i]) for i=0,...,p.length()-1
+// computed in parallel
+{
+    f.SetLength(p.length());
+    NTL_EXEC_RANGE(p.length(), first, last)
+    for(long i=first; i<last; i++) FactorPrime(f[i], p[i]);
+    NTL_EXEC_RANGE_END
+}
+
+static void factor(Vec<Pair<EE, long> >& f, const EE& a, const EEPrep *P)
 // f = factorization of a into Eisenstein primes
 // each element of f is a pair of prime and its exponent
 // such that product of prime^{exponent} is associate of a.
@@ -46,6 +57,7 @@ void factor(Vec<Pair<EE, long> >& f, const EE& a)
 // imaginary factors are appended after real factors
 // real factors are positive and sorted in increasing order
 // imaginary factors are primary and sorted by norm
+// P = prepared a if any, whose norm is used if GCD(a.x,a.y)==1
 {
     int i,j,k(0),e(0);
     ZZ s,t;
@@ -56,7 +68,7 @@ void factor(Vec<Pair<EE, long> >& f, const EE& a)
     GCD(t, a.x, a.y);
     b.x /= t;
     b.y /= t;
-    norm(s,b);
+    if(P && IsOne(t)) s = P->norm(); else norm(s,b);
     factor(g,s);
     factor(h,t);
     for(i=j=0; i<h.length(); i++) {
@@ -97,15 +109,60 @@ void factor(Vec<Pair<EE, long> >& f, const EE& a)
     }
 }
 
-void mul(EE& a, const Vec<Pair<EE, long> >& f)
-// a = product of (Eisenstein integer)^{exponent} in f
-// each element of f is a pair of integer and exponent
+void factor(Vec<Pair<EE, long> >& f, const EE& a) { factor(f,a,0); }
+void factor(Vec<Pair<EE, long> >& f, const EEPrep& a) { factor(f,a,&a); }
+
+template<class T>
+static void product(T& a, Vec<T>& v)
+// a = product of v[0],...,v[n-1] by balanced product tree
+// v is destroyed
+{
+    long i,n(v.length());
+    if(n==0) { set(a); return; }
+    for(; n>1; n=(n+1)>>1) {
+        for(i=0; 2*i+1<n; i++) mul(v[i], v[2*i], v[2*i+1]);
+        if(n&1) std::swap(v[i], v[n-1]);
+    }
+    std::swap(a, v[0]);
+}
+
+template<class T>
+static void MultiPower(T& a, const Vec<Pair<T, long> >& f)
+// a = product of f[j].a^{f[j].b} by simultaneous exponentiation
+//   a = (...(P[l-1]^2 * P[l-2])^2 ... )^2 * P[0]
+//   where P[i] = product of f[j].a such that bit i of f[j].b is 1
+// P[i] are computed by product trees in parallel
+// Assume f[j].b >= 0
 {
-    int i;
-    EE b;
-    set(a);
+    long i,l(0);
     for(i=0; i<f.length(); i++) {
-        power(b, f[i].a, f[i].b);
-        a *= b;
+        if(f[i].b < 0) Error("negative exponent in mul");
+        if(NumBits(f[i].b) > l) l = NumBits(f[i].b);
+    }
+    if(l==0) { set(a); return; }
+    Vec<T> P;
+    P.SetLength(l);
+    NTL_EXEC_RANGE(l, first, last)
+    for(long k=first; k<last; k++) {
+        Vec<T> v;
+        for(long j=0; j<f.length(); j++)
+            if(f[j].b>>k & 1) v.append(f[j].a);
+        product(P[k], v);
+    }
+    NTL_EXEC_RANGE_END
+    std::swap(a, P[l-1]);
+    for(i=l-2; i>=0; i--) {
+        sqr(a,a);
+        a *= P[i];
     }
-}
\ No newline at end of file
+}
+
+void mul(ZZ& a, const Vec<Pair<ZZ, long> >& f)
+// a = product of (integer)^{exponent} in f
+// each element of f is a pair of integer and exponent
+{ MultiPower(a,f); }
+
+void mul(EE& a, const Vec<Pair<EE, long> >& f)
+// a = product of (Eisenstein integer)^{exponent} in f
+// each element of f is a pair of integer and exponent
+{ MultiPower(a,f); }
\ No newline at end of file
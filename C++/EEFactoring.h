@@ -6,6 +6,7 @@
 
 #include<NTL/pair.h>
 #include "EE.h"
+#include "ZZFactoring.h"
 
 void factor(NTL::Vec<NTL::Pair<NTL::ZZ, long> >& f, const NTL::ZZ& n);
 // find x,y such that x^2 - xy + y^2 = p
@@ -21,6 +22,9 @@ void factor(NTL::Vec<NTL::Pair<EE, long> >& f, const EE& a);
 // real factors are positive and sorted in increasing order
 // imaginary factors are primary and sorted by norm
 
+void factor(NTL::Vec<NTL::Pair<EE, long> >& f, const EEPrep& a);
+// same as above but uses cached norm of a
+
 void mul(NTL::ZZ& a, const NTL::Vec<NTL::Pair<NTL::ZZ, long> >& f);
 // a = product of (integer)^{exponent} in f
 // each element of f is a pair of integer and exponent
@@ -0,0 +1,235 @@
+#include<NTL/BasicThreadPool.h>
+#include "EELog.h"
+#include "EEFactoring.h"
+
+typedef std::unordered_multimap<unsigned long, long>::const_iterator TableIter;
+
+static void MulMod(EE& c, const EE& a, const EE& b, const EEReducer& R)
+// c = a*b mod R.b
+{ mul(c,a,b); rem(c,c,R); }
+
+static void PowerMod(EE& b, const EE& a, const ZZ& n, const EEReducer& R)
+// b = a^n mod R.b; assume n>=0
+{
+    EE c(a);
+    set(b);
+    for(long k=NumBits(n)-1; k>=0; k--) {
+        sqr(b,b); rem(b,b,R);
+        if(bit(n,k)) { b*=c; rem(b,b,R); }
+    }
+}
+
+static unsigned long hash(const EE& a)
+// hash of canonical residue a
+{
+    return (unsigned long)trunc_long(a.x, NTL_BITS_PER_LONG)*0x9e3779b97f4a7c15UL
+         ^ (unsigned long)trunc_long(a.y, NTL_BITS_PER_LONG);
+}
+
+static long IsGenerator(const EELog& L, const EE& g)
+// return 1 if g^{N/l} != 1 for all prime factors l of N, else 0
+{
+    ZZ t;
+    EE a;
+    if(IsZero(g)) return 0;
+    for(long i=0; i<L.P.length(); i++) {
+        div(t, L.N, L.P[i].l);
+        PowerMod(a, g, t, L.R);
+        if(IsOne(a)) return 0;
+    }
+    return 1;
+}
+
+static void SetPrime(EELogPrime& P, const EELog& L)
+// P.g, P.h, baby steps P.T and giant step P.s
+{
+    long j;
+    ZZ t;
+    EE a;
+    div(t, L.N, P.q);
+    PowerMod(P.g, L.g, t, L.R);
+    div(t, L.N, P.l);
+    PowerMod(P.h, L.g, t, L.R);
+    P.T.clear();
+    if(P.l > EELOG_BSGS_MAX) { P.m = 0; return; }
+    P.m = SqrRoot(to_long(P.l)-1) + 1;// m^2 >= l
+    P.T.reserve(P.m);
+    set(a);
+    for(j=0; j<P.m; j++) {
+        P.T.insert(std::make_pair(hash(a), j));
+        MulMod(a, a, P.h, L.R);
+    }
+    sub(t, P.l, P.m % to_long(P.l));
+    PowerMod(P.s, P.h, t, L.R);
+}
+
+static void init(EELog& L, const EE *g)
+// factor N and set up subgroups for base *g
+// if g is null, L.g is searched from 0+w, 1+w, ...
+{
+    long i;
+    Vec<Pair<ZZ, long> > f;
+    if(!ProbPrime(L.p)) Error("EELog: p is not prime");
+    norm(L.N, L.p);
+    L.N--;
+    factor(f, L.N);
+    L.P.SetLength(f.length());
+    for(i=0; i<f.length(); i++) {
+        L.P[i].l = f[i].a;
+        L.P[i].e = f[i].b;
+        power(L.P[i].q, f[i].a, f[i].b);
+    }
+    if(!g) {
+        for(i=0;; i++) {
+            set(L.g, i, 1);
+            rem(L.g, L.g, L.R);
+            if(IsGenerator(L, L.g)) break;
+        }
+    }
+    else {
+        rem(L.g, *g, L.R);
+        if(!IsGenerator(L, L.g)) Error("EELog: not generator");
+    }
+    NTL_EXEC_RANGE(L.P.length(), first, last)
+    for(long j=first; j<last; j++) SetPrime(L.P[j], L);
+    NTL_EXEC_RANGE_END
+}
+
+EELog::EELog(const EE& a, const EE& b) : p(a), R(a,1) { init(*this, &b); }
+EELog::EELog(const EE& a) : p(a), R(a,1) { init(*this, 0); }
+
+static long bsgs(ZZ& x, const EE& b, const EELogPrime& P, const EEReducer& R)
+// x = logarithm of b to base P.h by baby-step giant-step
+// b * s^i = h^j gives x = im + j; candidates are verified
+//   since table is indexed by hash
+// return 0 if found, else -1
+{
+    long i;
+    EE c(b),t;
+    std::pair<TableIter, TableIter> r;
+    for(i=0; i<P.m; i++) {
+        r = P.T.equal_range(hash(c));
+        for(TableIter k=r.first; k!=r.second; k++) {
+            x = i;
+            x *= P.m;
+            x += k->second;
+            PowerMod(t, P.h, x, R);
+            if(t==b) return 0;
+        }
+        MulMod(c, c, P.s, R);
+    }
+    return -1;
+}
+
+static void step(EE& z, ZZ& u, ZZ& v, const EE& b,
+                 const EELogPrime& P, const EEReducer& R)
+// z = h^u b^v is moved by one of z*h, z*b, z^2 chosen by hash of z
+{
+    switch(hash(z)%3) {
+    case 0:
+        MulMod(z, z, P.h, R);
+        AddMod(u, u, 1, P.l);
+        break;
+    case 1:
+        MulMod(z, z, b, R);
+        AddMod(v, v, 1, P.l);
+        break;
+    default:
+        MulMod(z, z, z, R);
+        AddMod(u, u, u, P.l);
+        AddMod(v, v, v, P.l);
+    }
+}
+
+static void rho(ZZ& x, const EE& b, const EELogPrime& P, const EEReducer& R)
+// x = logarithm of b to base P.h
+// by Pollard rho method with Brent's cycle detection
+// h^u b^v = h^U b^V gives x = (u-U)/(V-v) mod l
+// reference:
+//   J. M. Pollard "Monte Carlo Methods for Index Computation (mod p)"
+//     Math. Comp. 32 (1978) 918
+{
+    long i,r;
+    ZZ u,v,U,V;
+    EE z,Z,t;
+    for(;;) {
+        RandomBnd(u, P.l);
+        RandomBnd(v, P.l);
+        PowerMod(z, P.h, u, R);
+        PowerMod(t, b, v, R);
+        MulMod(z, z, t, R);
+        for(r=1;; r<<=1) {
+            Z = z; U = u; V = v;
+            for(i=0; i<r; i++) {
+                step(z, u, v, b, P, R);
+                if(z==Z) break;
+            }
+            if(i<r) break;
+        }
+        SubMod(V, V, v, P.l);
+        if(IsZero(V)) continue;
+        SubMod(u, u, U, P.l);
+        InvMod(V, V, P.l);
+        MulMod(x, u, V, P.l);
+        return;
+    }
+}
+
+static void SubLog(ZZ& x, const EE& b, const EELogPrime& P, const EEReducer& R)
+// x = logarithm of b to base P.h; assume b^l = 1
+{
+    if(IsOne(b)) clear(x);
+    else if(P.m == 0) rho(x,b,P,R);
+    else if(bsgs(x,b,P,R)) Error("DiscreteLog: not found");
+}
+
+long DiscreteLog(ZZ& x, const EE& a, const EELog& L)
+// for each l^e, logarithm n of c = a^{N/l^e} to base P.g = g^{N/l^e}
+//   is found digit by digit n = d_0 + d_1 l + ... + d_{e-1} l^{e-1}
+//   where d_k = log of (c P.g^{-n})^{l^{e-1-k}} to base P.h
+// and x is found by CRT
+// reference:
+//   S. Pohlig and M. Hellman "An Improved Algorithm for Computing
+//     Logarithms over GF(p) and Its Cryptographic Significance"
+//     IEEE Trans. Inform. Theory 24 (1978) 106
+{
+    long i,k;
+    ZZ y,m,n,d,s,t;
+    EE b,c,u;
+    rem(b, a, L.R);
+    if(IsZero(b)) return -1;
+    clear(y);
+    set(m);
+    for(i=0; i<L.P.length(); i++) {
+        const EELogPrime& P(L.P[i]);
+        div(t, L.N, P.q);
+        PowerMod(c, b, t, L.R);
+        clear(n);
+        set(s);// l^k
+        div(d, P.q, P.l);// l^{e-1-k}
+        for(k=0; k<P.e; k++) {
+            sub(t, P.q, n);
+            PowerMod(u, P.g, t, L.R);
+            MulMod(u, u, c, L.R);
+            PowerMod(u, u, d, L.R);
+            SubLog(t, u, P, L.R);
+            MulAddTo(n, t, s);
+            s *= P.l;
+            d /= P.l;
+        }
+        CRT(y, m, n, P.q);
+    }
+    if(sign(y) < 0) y += m;
+    x = y;
+    return 0;
+}
+
+void DiscreteLog(Vec<ZZ>& x, const Vec<EE>& a, const EELog& L)
+// computed in parallel
+{
+    x.SetLength(a.length());
+    NTL_EXEC_RANGE(a.length(), first, last)
+    for(long i=first; i<last; i++)
+        if(DiscreteLog(x[i], a[i], L)) x[i] = -1;
+    NTL_EXEC_RANGE_END
+}
@@ -0,0 +1,49 @@
+// discrete logarithms in residue fields of Eisenstein integers
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __EELog_h__
+#define __EELog_h__
+
+#include<unordered_map>
+#include "EE.h"
+
+#define EELOG_BSGS_MAX (1L<<40) // baby-step giant-step for l <= this
+
+struct EELogPrime {
+    // subgroup of (Z[w]/p)^* of order l^e
+    ZZ l;// prime factor of N
+    long e;// exponent of l in N
+    ZZ q;// l^e
+    EE g;// g^{N/q}, generator of subgroup of order q
+    EE h;// g^{N/l}, generator of subgroup of order l
+    long m;// number of baby steps, or 0 if Pollard rho is used
+    EE s;// h^{-m}, giant step
+    std::unordered_multimap<unsigned long, long> T;// hash of h^j -> j
+};
+
+struct EELog {
+    // precomputation of discrete logarithms to base g
+    // in (Z[w]/p)^* of order N = norm(p)-1
+    // by Pohlig-Hellman method over prime factors l of N
+    // and baby-step giant-step (l <= EELOG_BSGS_MAX)
+    // or Pollard rho method (l > EELOG_BSGS_MAX) for each l
+    EE p,g;// g is canonical residue mod p
+    ZZ N;
+    EEReducer R;// canonical residues mod p
+    Vec<EELogPrime> P;
+    EELog(const EE& p, const EE& g);// Error if g is not generator (or 0)
+    explicit EELog(const EE& p);// search g = first generator in 0+w, 1+w, ...
+};
+// Assume p is prime
+
+long DiscreteLog(ZZ& x, const EE& a, const EELog& L);
+// x = logarithm of a to base L.g, 0 <= x < L.N
+// return 0, or -1 if a==0 (mod L.p)
+
+void DiscreteLog(Vec<ZZ>& x, const Vec<EE>& a, const EELog& L);
+// x[i] = DiscreteLog(a[i]) for i=0,...,a.length()-1
+//   or x[i] = -1 if a[i]==0 (mod L.p)
+// computed in parallel
+
+#endif // __EELog_h__
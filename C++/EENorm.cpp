@@ -0,0 +1,209 @@
+#include<NTL/BasicThreadPool.h>
+#include "EENorm.h"
+#include "EEFactoring.h"
+
+#define NORM_SEGMENT (1<<16) // integers per segment
+#define NORM_BATCH   4       // segments per thread in parallel
+
+void EENormSeq::init(const Vec<EE>& p)
+// powers of p[i] and their conjugates
+{
+    long i,l;
+    P.SetLength(p.length());
+    Q.SetLength(p.length());
+    for(i=0; i<p.length(); i++) {
+        P[i].SetLength(e[i]+1);
+        Q[i].SetLength(e[i]+1);
+        set(P[i][0]);
+        set(Q[i][0]);
+        conj(Q[i][1], p[i]);
+        for(l=1; l<=e[i]; l++) {
+            mul(P[i][l], P[i][l-1], p[i]);
+            mul(Q[i][l], Q[i][l-1], Q[i][1]);
+        }
+    }
+    reset();
+}
+
+EENormSeq::EENormSeq(const EE& c_, const Vec<EE>& p, const Vec<long>& e_, long all_)
+: c(c_), e(e_), all(all_) { init(p); }
+
+EENormSeq::EENormSeq(const Vec<Pair<ZZ, long> >& f, long all_)
+: all(all_)
+// 3 = -w^2 (1-w)^2 and q==2 (mod 3) is inert
+{
+    long i,l;
+    EE t;
+    Vec<EE> p;
+    set(c);
+    for(i=0; i<f.length(); i++) {
+        if(f[i].a == 3) {
+            set(t,1,-1);
+            power(t, t, f[i].b);
+            c *= t;
+        }
+        else if(f[i].a%3 == 2) {
+            if(f[i].b & 1) { clear(c); break; }
+            power(t.x, f[i].a, f[i].b>>1);
+            mul(c.x, c.x, t.x);
+            mul(c.y, c.y, t.x);
+        }
+        else {
+            l = p.length();
+            p.SetLength(l+1);
+            FactorPrime(p[l], f[i].a);
+            e.append(f[i].b);
+        }
+    }
+    if(IsZero(c)) { p.SetLength(0); e.SetLength(0); }
+    init(p);
+}
+
+EENormSeq::EENormSeq(const ZZ& n, long all_)
+: all(all_)
+{
+    if(n <= 0) Error("EENormSeq: n must be positive");
+    Vec<Pair<ZZ, long> > f;
+    factor(f,n);
+    *this = EENormSeq(f, all_);
+}
+
+void EENormSeq::reset() {
+    k.SetLength(e.length());
+    for(long i=0; i<k.length(); i++) k[i] = 0;
+    j = 0;
+    done = IsZero(c);
+}
+
+long EENormSeq::next(EE& a)
+// exponents k[i] are counted up in mixed radix e[i]+1
+{
+    long i;
+    if(done) return 0;
+    if(j==0) {
+        b = c;
+        for(i=0; i<k.length(); i++) {
+            b *= P[i][k[i]];
+            b *= Q[i][e[i]-k[i]];
+        }
+        FirstHex(b,b);
+    }
+    rot60(a,b,j);
+    if(all && ++j<6) return 1;
+    j = 0;
+    for(i=0; i<k.length() && ++k[i] > e[i]; i++) k[i] = 0;
+    if(i==k.length()) done = 1;
+    return 1;
+}
+
+long EENormSeq::count() const {
+    if(IsZero(c)) return 0;
+    long i,m(all ? 6:1);
+    for(i=0; i<e.length(); i++) m *= e[i]+1;
+    return m;
+}
+
+static void NormSegment(Vec<long>& n, Vec<Vec<EE> >& r, long lo, long hi,
+                        long all, const Vec<long>& q, const Vec<EE>& s)
+// n = integers in [lo,hi) that are norms, r = their representations
+// q = primes up to sqrt(hi), s[i] = split of q[i] if q[i]==1 (mod 3)
+{
+    long i,j,l,t,x,y,m(hi-lo);
+    Vec<long> u,hd,nx,fp,fe;
+    Vec<char> ok;
+    u.SetLength(m);
+    hd.SetLength(m);
+    ok.SetLength(m);
+    for(i=0; i<m; i++) { u[i] = lo+i; hd[i] = -1; ok[i] = 1; }
+    for(t=0; t<q.length() && q[t]*q[t] < hi; t++) {
+        for(i=(lo + q[t]-1)/q[t]*q[t] - lo; i<m; i+=q[t]) {
+            for(j=0; u[i]%q[t] == 0; j++) u[i] /= q[t];
+            if(q[t]%3 == 2 && (j&1)) ok[i] = 0;
+            if(!ok[i]) continue;
+            l = fp.length();// linked list of factors of lo+i
+            fp.append(t);
+            fe.append(j);
+            nx.append(hd[i]);
+            hd[i] = l;
+        }
+    }
+    n.SetLength(0);
+    r.SetLength(0);
+    for(i=0; i<m; i++) {// u[i] = 1 or prime > sqrt(hi)
+        if(!ok[i] || u[i]%3 == 2) continue;
+        EE c,a;
+        Vec<EE> p;
+        Vec<long> e;
+        set(c);
+        if(u[i]==3) set(c,1,-1);
+        else if(u[i]>1) {
+            p.SetLength(1);
+            FactorPrime(x,y,u[i]);
+            set(p[0],x,y);
+            e.append(1);
+        }
+        for(l=hd[i]; l>=0; l=nx[l]) {
+            t = fp[l];
+            if(q[t]==3) {
+                set(a,1,-1);
+                power(a, a, fe[l]);
+                c *= a;
+            }
+            else if(q[t]%3 == 2) {
+                power(a.x, ZZ(q[t]), fe[l]>>1);
+                mul(c.x, c.x, a.x);
+                mul(c.y, c.y, a.x);
+            }
+            else {
+                p.append(s[t]);
+                e.append(fe[l]);
+            }
+        }
+        EENormSeq S(c,p,e,all);
+        n.append(lo+i);
+        r.SetLength(r.length()+1);
+        while(S.next(a)) r[r.length()-1].append(a);
+    }
+}
+
+void EENorms(long N0, long N1,
+             const std::function<void(long, const Vec<EE>&)>& f, long all)
+// integers are factored by sieve in segments in parallel
+{
+    if(N1 > NTL_SP_BOUND) Error("N1 too large in EENorms");
+    if(N0 < 1) N0 = 1;
+    if(N0 >= N1) return;
+    long i,k,n,b,lo(N0),x,y,sn(SqrRoot(N1-1));
+    Vec<long> q;
+    Vec<EE> s;
+    Vec<Vec<long> > m;
+    Vec<Vec<Vec<EE> > > r;
+    PrimeSeq ps;
+    while((i = ps.next()) <= sn) {
+        if(i==0) Error("N1 too large in EENorms");
+        q.append(i);
+    }
+    s.SetLength(q.length());
+    for(i=0; i<q.length(); i++) {
+        if(q[i]%3 != 1) continue;
+        FactorPrime(x,y,q[i]);
+        set(s[i],x,y);
+    }
+    b = AvailableThreads()*NORM_BATCH;
+    m.SetLength(b);
+    r.SetLength(b);
+    while(lo < N1) {
+        n = (N1 - lo + NORM_SEGMENT-1)/NORM_SEGMENT;
+        if(n > b) n = b;
+        NTL_EXEC_RANGE(n, first, last)
+        for(long j=first; j<last; j++) {
+            long u(lo + j*NORM_SEGMENT), v(u + NORM_SEGMENT);
+            if(v > N1) v = N1;
+            NormSegment(m[j], r[j], u, v, all, q, s);
+        }
+        NTL_EXEC_RANGE_END
+        for(i=0; i<n; i++)
+            for(k=0; k<m[i].length(); k++) f(m[i][k], r[i][k]);
+        lo += n*NORM_SEGMENT;
+    }
+}
@@ -0,0 +1,55 @@
+// Eisenstein integers of given norm, i.e.,
+// representations of n by x^2 - xy + y^2
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __EENorm_h__
+#define __EENorm_h__
+
+#include<NTL/pair.h>
+#include "EE.h"
+
+class EENormSeq {
+    // generator of Eisenstein integers a such that norm(a) = n
+    //   a = c * prod p[i]^k[i] conj(p[i])^{e[i]-k[i]} (0 <= k[i] <= e[i])
+    //   where n = norm(c) * prod norm(p[i])^e[i] and c is
+    //   product of 1-w and rational primes q==2 (mod 3)
+    // usage: EE a; for(EENormSeq s(n); s.next(a);) { ... }
+    EE c,b;
+    Vec<Vec<EE> > P,Q;// P[i][k] = p[i]^k, Q[i][k] = conj(p[i])^k
+    Vec<long> e,k;
+    long all;// nonzero if all associates are generated
+    long j;// b is rotated by (1+w)^j
+    long done;
+    void init(const Vec<EE>& p);
+public:
+    EENormSeq(const ZZ& n, long all=0);
+    // n is factored once; Assume n>=1
+    EENormSeq(const Vec<Pair<ZZ, long> >& f, long all=0);
+    // f = factorization of n as by factor(f,n)
+    EENormSeq(const EE& c, const Vec<EE>& p, const Vec<long>& e, long all=0);
+    // c, p[i], e[i] as above; p[i] are primes of prime norm
+    //   of distinct norms
+    long next(EE& a);
+    // a = next Eisenstein integer of norm n
+    //   in first hexant 0 <= arg(a) < 60 if all==0
+    //   or each of its six associates in turn if all!=0
+    // return 1, or 0 if there are no more
+    void reset();// restart from the first one
+    long count() const;
+    // number of a generated, i.e.,
+    // prod (e[i]+1) (times 6 if all!=0) or 0 if n is not norm
+};
+
+void EENorms(long N0, long N1,
+             const std::function<void(long, const Vec<EE>&)>& f,
+             long all=0);
+// call f(n,a) for every n, N0 <= n < N1, which is norm of
+//   some Eisenstein integer, in increasing order of n,
+//   where a = all x+yw such that x^2 - xy + y^2 = n
+//   in first hexant if all==0 (as by EENormSeq above)
+// n are factored by sieve in segments in parallel and
+//   splits of small primes are computed once
+// Assume 1 <= N0 and N1 <= NTL_SP_BOUND
+
+#endif // __EENorm_h__
@@ -0,0 +1,129 @@
+#include<cmath>
+#include<NTL/BasicThreadPool.h>
+#include "EE.h"
+
+#define EEPRIMES_SEGMENT (1<<17) // odd numbers per segment (bytes)
+#define EEPRIMES_BATCH   4       // segments per thread in parallel
+
+long SqrRootMod(long a, long p);
+
+static unsigned long SqrRoot64(unsigned long n)
+// return floor(sqrt(n))
+{
+    unsigned long r(sqrtl(n));
+    while((unsigned __int128)r*r > n) r--;
+    while((unsigned __int128)(r+1)*(r+1) <= n) r++;
+    return r;
+}
+
+static void primary(long& x, long& y)
+// x+yw = unit * (x+yw) such that x==2 and y==0 (mod 3)
+// word-size version of primary in EE.cpp
+{
+    long t,a((x%3+3)%3), b((y%3+3)%3);
+    if(a==b) { t=x; x=-y; y=t-y; }// rot120
+    else if(a==0) { t=x; x-=y; y=t; }// rot60
+    else {
+        if(a==1) { x=-x; y=-y; }
+        return;
+    }
+    if(b==2) { x=-x; y=-y; }
+}
+
+void FactorPrime(long& x, long& y, long p)
+// find x,y such that x^2 - xy + y^2 = p and x==2, y==0 (mod 3)
+// Assume p is prime, p==1 (mod 3) and p < 2^62
+// by Cornacchia's algorithm for A^2 + 3B^2 = 4p, A=2x-y, B=y
+// reference: H. Cohen
+//   "A Course in Computational Algebraic Number Theory" 1.5.3
+{
+    unsigned long a(p<<1),b(SqrRootMod(p-3,p)),c((unsigned long)p<<2),t;
+    unsigned long l(SqrRoot64(c));
+    if((b&1)==0) b = p-b;
+    while(b>l) { t = a%b; a = b; b = t; }
+    y = SqrRoot64((c - b*b)/3);
+    x = (b+y)>>1;
+    primary(x,y);
+}
+
+static void PrimeSegment(Vec<long>& r, long lo, long hi,
+                         const Vec<long>& q, const Vec<long>& s)
+// r = x,y,x,y,... of primary primes with lo <= norm < hi
+//     in increasing order of norm (conjugates follow each other)
+// q = odd primes up to sqrt(hi)
+// s = primes ==2 (mod 3) up to sqrt(hi)
+// assume lo is even
+{
+    long i,j,n,x,y,m((hi-lo)>>1);
+    Vec<char> sv;
+    sv.SetLength(m);
+    for(i=0; i<m; i++) sv[i] = 1;
+    for(i=0; i<q.length() && q[i]*q[i] < hi; i++) {
+        n = (lo + q[i]-1)/q[i]*q[i];
+        if(n < q[i]*q[i]) n = q[i]*q[i];
+        if((n&1)==0) n += q[i];
+        for(j=(n-lo)>>1; j<m; j+=q[i]) sv[j] = 0;
+    }
+    r.SetLength(0);
+    for(j=0; j<s.length() && s[j]*s[j] < lo; j++);
+    for(i=0; i<m; i++) {
+        n = lo + (i<<1) + 1;
+        for(; j<s.length() && s[j]*s[j] < n; j++) {
+            r.append(s[j]); r.append(0);
+        }
+        if(n==1 || !sv[i]) continue;
+        if(n==3) { r.append(1); r.append(-1); }
+        else if(n%3 == 1) {
+            FactorPrime(x,y,n);
+            r.append(x); r.append(y);
+            r.append(x-y); r.append(-y);
+        }
+    }
+    for(; j<s.length() && s[j]*s[j] < hi; j++) {
+        r.append(s[j]); r.append(0);
+    }
+}
+
+void EEPrimes(long N, const std::function<void(long, long)>& f)
+// call f(x,y) for every primary prime x+yw with norm <= N
+// in increasing order of norm; primes of the same norm are
+// a split prime followed by its conjugate
+// rational primes are sieved in segments in parallel
+// Assume N < 2^62
+{
+    if(N < 3) return;
+    if(N >= (1L<<62)) Error("N too large in EEPrimes");
+    long i,k,l,n,b,lo(0),sn(SqrRoot64(N));
+    Vec<long> q,s;
+    Vec<Vec<long> > r;
+    PrimeSeq ps;
+    while((i = ps.next()) <= sn) {
+        if(i==0) Error("N too large in EEPrimes");
+        if(i>2) q.append(i);
+        if(i%3 == 2) s.append(i);
+    }
+    b = AvailableThreads()*EEPRIMES_BATCH;
+    r.SetLength(b);
+    while(lo <= N) {
+        l = 2*EEPRIMES_SEGMENT;
+        n = (N - lo)/l + 1;
+        if(n > b) n = b;
+        NTL_EXEC_RANGE(n, first, last)
+        for(long j=first; j<last; j++) {
+            long u(lo + j*l), v(u+l);
+            if(v > N+1) v = N+1;
+            PrimeSegment(r[j], u, v, q, s);
+        }
+        NTL_EXEC_RANGE_END
+        for(i=0; i<n; i++)
+            for(k=0; k<r[i].length(); k+=2) f(r[i][k], r[i][k+1]);
+        lo += n*l;
+    }
+}
+
+void EEPrimes(Vec<EE>& p, long N)
+// p = primary primes with norm <= N in the order of EEPrimes above
+{
+    p.SetLength(0);
+    EEPrimes(N, [&p](long x, long y) { p.append(EE(x,y)); });
+}
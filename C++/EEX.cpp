@@ -0,0 +1,315 @@
+#include<mutex>
+#include<NTL/lzz_pX.h>
+#include<NTL/BasicThreadPool.h>
+#include "EEX.h"
+
+#define EEX_FFT_K 25 // primes p==1 (mod 3*2^EEX_FFT_K) for FFT
+
+void EEX::normalize() {
+    long n(rep.length());
+    while(n>0 && IsZero(rep[n-1])) n--;
+    rep.SetLength(n);
+}
+
+std::ostream& operator<<(std::ostream& s, const EEX& a) {
+    s << '[';
+    for(long i=0; i<a.rep.length(); i++) {
+        if(i) s << ' ';
+        s << a.rep[i];
+    }
+    s << ']';
+    return s;
+}
+
+EE coeff(const EEX& a, long i) {
+    if(i<0 || i>deg(a)) return EE();
+    return a.rep[i];
+}
+
+const EE& LeadCoeff(const EEX& a) {
+    if(IsZero(a)) Error("LeadCoeff: zero polynomial");
+    return a.rep[deg(a)];
+}
+
+void SetCoeff(EEX& a, long i, const EE& c) {
+    long n(a.rep.length());
+    if(i<0) Error("SetCoeff: negative index");
+    if(i>=n) {
+        if(IsZero(c)) return;
+        a.rep.SetLength(i+1);
+    }
+    a.rep[i] = c;
+    if(i==n-1) a.normalize();
+}
+
+void clear(EEX& a) { a.rep.SetLength(0); }
+void set(EEX& a) { a.rep.SetLength(1); set(a.rep[0]); }
+
+void add(EEX& c, const EEX& a, const EEX& b) {
+    long i,m(a.rep.length()),n(b.rep.length());
+    if(m<n) { add(c,b,a); return; }
+    c.rep.SetLength(m);
+    for(i=0; i<n; i++) add(c.rep[i], a.rep[i], b.rep[i]);
+    if(&c!=&a) for(; i<m; i++) c.rep[i] = a.rep[i];
+    c.normalize();
+}
+
+void sub(EEX& c, const EEX& a, const EEX& b) {
+    long i,m(a.rep.length()),n(b.rep.length());
+    c.rep.SetLength(m>n ? m:n);
+    for(i=0; i<m && i<n; i++) sub(c.rep[i], a.rep[i], b.rep[i]);
+    if(&c!=&a) for(; i<m; i++) c.rep[i] = a.rep[i];
+    for(; i<n; i++) negate(c.rep[i], b.rep[i]);
+    c.normalize();
+}
+
+void negate(EEX& b, const EEX& a) {
+    b.rep.SetLength(a.rep.length());
+    for(long i=0; i<a.rep.length(); i++) negate(b.rep[i], a.rep[i]);
+}
+
+void mul(EEX& c, const EEX& a, const EE& b) {
+    c.rep.SetLength(a.rep.length());
+    for(long i=0; i<a.rep.length(); i++) mul(c.rep[i], a.rep[i], b);
+    c.normalize();
+}
+
+static void PlainMul(EEX& c, const EEX& a, const EEX& b)
+// c=a*b by schoolbook method
+{
+    long i,j,m(a.rep.length()),n(b.rep.length());
+    EE t;
+    EEX d;
+    d.rep.SetLength(m+n-1);
+    for(i=0; i<m; i++)
+        for(j=0; j<n; j++) {
+            mul(t, a.rep[i], b.rep[j]);
+            d.rep[i+j] += t;
+        }
+    swap(c.rep, d.rep);
+    c.normalize();
+}
+
+struct FFTPrime {
+    long p;// prime p < NTL_SP_BOUND, p==1 (mod 3*2^EEX_FFT_K)
+    long w;// primitive cubic root of 1 in F_p
+    zz_pContext c;// FFT context for p
+};
+
+static void FFTPrimes(Vec<FFTPrime>& P, long k)
+// P = k largest primes p described above
+// the list is extended on demand and shared by threads
+{
+    static std::mutex m;
+    static Vec<FFTPrime> Q;
+    static long c((NTL_SP_BOUND-1)/(3L<<EEX_FFT_K));
+    long i,p,w;
+    std::lock_guard<std::mutex> lk(m);
+    for(; Q.length() < k; c--) {
+        if(c<=0) Error("EEX: too large coefficients");
+        p = c*(3L<<EEX_FFT_K) + 1;
+        if(!ProbPrime(p)) continue;
+        for(i=2; (w = PowerMod(i, (p-1)/3, p)) == 1; i++);
+        Q.SetLength(Q.length()+1);
+        Q[Q.length()-1].p = p;
+        Q[Q.length()-1].w = w;
+        Q[Q.length()-1].c = zz_pContext(INIT_USER_FFT, p);
+    }
+    P.SetLength(k);
+    for(i=0; i<k; i++) P[i] = Q[i];
+}
+
+static void MaxNorm(ZZ& M, const EEX& a)
+// M = max of |x|+|y| over coefficients x+yw of a
+{
+    ZZ t;
+    clear(M);
+    for(long i=0; i<a.rep.length(); i++) {
+        add(t, abs(a.rep[i].x), abs(a.rep[i].y));
+        if(t>M) M=t;
+    }
+}
+
+static void embed(zz_pX& f, zz_pX& g, const EEX& a, zz_p w)
+// f = image of a by w -> w (mod p)
+// g = image of a by w -> w^2 (mod p)
+{
+    long i,n(a.rep.length()),p(zz_p::modulus());
+    zz_p x,y,u(-1-w);
+    f.rep.SetLength(n);
+    g.rep.SetLength(n);
+    for(i=0; i<n; i++) {
+        conv(x, rem(a.rep[i].x, p));
+        conv(y, rem(a.rep[i].y, p));
+        f.rep[i] = x + w*y;
+        g.rep[i] = x + u*y;
+    }
+    f.normalize();
+    g.normalize();
+}
+
+static void FFTMul(EEX& c, const EEX& a, const EEX& b)
+// c=a*b by FFT modulo primes p==1 (mod 3)
+// coefficient x+yw of c is found by
+//   x+yw (mod p) = u,  x+yw^2 (mod p) = v, u,v in F_p
+//   y = (u-v)/(w-w^2), x = u-wy
+// and x,y are recovered by CRT over primes
+{
+    long k,m(a.rep.length()),n(b.rep.length()),l(m+n-1);
+    ZZ Ma,Mb;
+    MaxNorm(Ma,a);
+    MaxNorm(Mb,b);
+    // |x|,|y| <= min(m,n)*Ma*Mb
+    k = NumBits(Ma) + NumBits(Mb) + NumBits(m<n ? m:n) + 2;
+    k = (k + NTL_SP_NBITS-2)/(NTL_SP_NBITS-1);
+    Vec<FFTPrime> P;
+    Vec<Vec<long> > X,Y;
+    FFTPrimes(P,k);
+    X.SetLength(k);
+    Y.SetLength(k);
+    NTL_EXEC_RANGE(k, first, last)
+    for(long j=first; j<last; j++) {
+        zz_pPush push(P[j].c);
+        zz_p w(to_zz_p(P[j].w)),d,u,v;
+        zz_pX f,g,s,t;
+        inv(d, w+w+1);// 1/(w-w^2)
+        embed(f,g,a,w);
+        if(&a==&b) { sqr(f,f); sqr(g,g); }
+        else {
+            embed(s,t,b,w);
+            mul(f,f,s);
+            mul(g,g,t);
+        }
+        X[j].SetLength(l);
+        Y[j].SetLength(l);
+        for(long r=0; r<l; r++) {
+            u = coeff(f,r);
+            v = coeff(g,r);
+            v = (u-v)*d;
+            Y[j][r] = rep(v);
+            X[j][r] = rep(u - w*v);
+        }
+    }
+    NTL_EXEC_RANGE_END
+    c.rep.SetLength(l);
+    NTL_EXEC_RANGE(l, first, last)
+    for(long r=first; r<last; r++) {
+        ZZ p,q;
+        clear(c.rep[r].x);
+        clear(c.rep[r].y);
+        set(p);
+        for(long j=0; j<k; j++) {
+            q = p;
+            CRT(c.rep[r].x, p, X[j][r], P[j].p);
+            CRT(c.rep[r].y, q, Y[j][r], P[j].p);
+        }
+    }
+    NTL_EXEC_RANGE_END
+    c.normalize();
+}
+
+void mul(EEX& c, const EEX& a, const EEX& b) {
+    if(IsZero(a) || IsZero(b)) { clear(c); return; }
+    if(a.rep.length() < EEX_CROSSOVER || b.rep.length() < EEX_CROSSOVER)
+        PlainMul(c,a,b);
+    else FFTMul(c,a,b);
+}
+
+void sqr(EEX& b, const EEX& a) { mul(b,a,a); }
+
+static void trunc(EEX& b, const EEX& a, long m)
+// b = a mod X^m
+{
+    if(&b!=&a) b=a;
+    if(b.rep.length() > m) {
+        b.rep.SetLength(m);
+        b.normalize();
+    }
+}
+
+static void reverse(EEX& b, const EEX& a, long d)
+// b = X^d * a(1/X); assume deg(a) <= d
+{
+    long i;
+    EEX c;
+    c.rep.SetLength(d+1);
+    for(i=0; i<a.rep.length(); i++) c.rep[d-i] = a.rep[i];
+    swap(b.rep, c.rep);
+    b.normalize();
+}
+
+static void InvTrunc(EEX& g, const EEX& f, long m)
+// g = f^{-1} mod X^m by Newton iteration g = g(2-fg)
+// Assume f(0) is unit
+{
+    long k;
+    EE u;
+    EEX t;
+    conj(u, f.rep[0]);// inverse of unit
+    g = EEX(u);
+    for(k=1; k<m;) {
+        k = (2*k < m ? 2*k : m);
+        trunc(t,f,k);
+        mul(t,t,g);
+        trunc(t,t,k);
+        negate(t,t);
+        t.rep[0] += EE(2);
+        t.normalize();
+        mul(g,g,t);
+        trunc(g,g,k);
+    }
+}
+
+void DivRem(EEX& q, EEX& r, const EEX& a, const EEX& b) {
+    long i,j,m(deg(a)),n(deg(b));
+    EE u,t;
+    if(n<0) Error("DivRem: division by zero");
+    if(!IsUnit(LeadCoeff(b))) Error("DivRem: leading coefficient not unit");
+    if(m<n) { r=a; clear(q); return; }
+    conj(u, LeadCoeff(b));
+    EEX s,c;
+    if(n < EEX_CROSSOVER || m-n < EEX_CROSSOVER) {
+        c = a;
+        s.rep.SetLength(m-n+1);
+        for(i=m-n; i>=0; i--) {
+            mul(s.rep[i], c.rep[i+n], u);
+            for(j=0; j<=n; j++) {
+                mul(t, s.rep[i], b.rep[j]);
+                c.rep[i+j] -= t;
+            }
+        }
+        c.normalize();
+    }
+    else {
+        EEX g,h;
+        reverse(h,b,n);
+        InvTrunc(g, h, m-n+1);
+        reverse(s,a,m);
+        trunc(s, s, m-n+1);
+        mul(s,s,g);
+        trunc(s, s, m-n+1);
+        reverse(s, s, m-n);
+        mul(c,b,s);
+        sub(c,a,c);
+    }
+    swap(q.rep, s.rep);
+    swap(r.rep, c.rep);
+}
+
+void div(EEX& q, const EEX& a, const EEX& b) { EEX r; DivRem(q,r,a,b); }
+void rem(EEX& r, const EEX& a, const EEX& b) { EEX q; DivRem(q,r,a,b); }
+
+void eval(EE& b, const EEX& f, const EE& a)
+// by Horner's method
+{
+    EE c;
+    for(long i=deg(f); i>=0; i--) {
+        c *= a;
+        c += f.rep[i];
+    }
+    b = c;
+}
+
+EEX& operator+=(EEX& b, const EEX& a) { add(b,b,a); return b; }
+EEX& operator-=(EEX& b, const EEX& a) { sub(b,b,a); return b; }
+EEX& operator*=(EEX& b, const EEX& a) { mul(b,b,a); return b; }
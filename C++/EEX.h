@@ -0,0 +1,62 @@
+// polynomials with Eisenstein integer coefficients
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __EEX_h__
+#define __EEX_h__
+
+#include "EE.h"
+
+#define EEX_CROSSOVER 32 // schoolbook arithmetic below this length
+
+struct EEX {
+    // polynomial rep[0] + rep[1]X + ... + rep[n]X^n
+    // rep[n] != 0 if normalized; rep is empty if zero
+    Vec<EE> rep;
+    EEX() {;}// zero
+    EEX(const EE& a) { if(!IsZero(a)) rep.append(a); }// constant a
+    void normalize();// strip leading zeros
+};
+
+std::ostream& operator<<(std::ostream& s, const EEX& a);
+// output a to s as [rep[0] rep[1] ... rep[n]]
+
+inline long deg(const EEX& a) { return a.rep.length()-1; }
+// degree of a; -1 if a==0
+
+EE coeff(const EEX& a, long i);// coefficient of X^i (0 if i > deg(a))
+const EE& LeadCoeff(const EEX& a);// coefficient of X^deg(a); Error if a==0
+void SetCoeff(EEX& a, long i, const EE& c);// coefficient of X^i = c
+
+inline long IsZero(const EEX& a) { return a.rep.length()==0; }
+inline long operator==(const EEX& a, const EEX& b) { return a.rep==b.rep; }
+inline long operator!=(const EEX& a, const EEX& b) { return !(a.rep==b.rep); }
+
+void clear(EEX& a);// a=0
+void set(EEX& a);// a=1
+
+void add(EEX& c, const EEX& a, const EEX& b);// c=a+b
+void sub(EEX& c, const EEX& a, const EEX& b);// c=a-b
+void negate(EEX& b, const EEX& a);// b=-a
+void mul(EEX& c, const EEX& a, const EE& b);// c=a*b
+void mul(EEX& c, const EEX& a, const EEX& b);// c=a*b
+void sqr(EEX& b, const EEX& a);// b=a*a
+// if both lengths are EEX_CROSSOVER or more, multiplication is done
+// by FFT modulo primes p==1 (mod 3) in parallel
+// where w is mapped to both cubic roots of unity in F_p,
+// and coefficients are recovered by CRT
+
+void DivRem(EEX& q, EEX& r, const EEX& a, const EEX& b);
+// q = a/b, r = a%b such that a = bq + r and deg(r) < deg(b)
+// Assume leading coefficient of b is unit
+// by Newton iteration for inverse of reversal of b if degrees are large
+void div(EEX& q, const EEX& a, const EEX& b);// q=a/b
+void rem(EEX& r, const EEX& a, const EEX& b);// r=a%b
+
+void eval(EE& b, const EEX& f, const EE& a);// b = f(a)
+
+EEX& operator+=(EEX& b, const EEX& a);// b+=a
+EEX& operator-=(EEX& b, const EEX& a);// b-=a
+EEX& operator*=(EEX& b, const EEX& a);// b*=a
+
+#endif // __EEX_h__
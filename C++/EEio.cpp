@@ -0,0 +1,231 @@
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<cstring>
+#include "EEio.h"
+
+#define EEIO_BUFFER (1<<16) // size of write buffer
+
+static const char EEIO_MAGIC[4] = {'E','E','b','\032'};
+
+typedef Vec<Pair<EE, long> > vec_pair_EE_long;
+typedef Vec<Pair<ZZ, long> > vec_pair_ZZ_long;
+
+static void PutWord(std::string& s, unsigned long a, long n)
+// append n bytes of a to s in little endian
+{
+    for(long i=0; i<n; i++) s.push_back(char((a >> (8*i)) & 0xff));
+}
+
+static unsigned long GetWord(const unsigned char *p, long n)
+// return n bytes at p in little endian
+{
+    unsigned long a(0);
+    for(long i=n-1; i>=0; i--) a = (a<<8) | p[i];
+    return a;
+}
+
+void WriteBinary(std::string& s, const ZZ& a) {
+    long n(NumBytes(a)),k(s.size());
+    if(n >= (1L<<31)) Error("WriteBinary: too large");
+    PutWord(s, (n<<1) | (sign(a)<0), 4);
+    s.resize(k+4+n);
+    BytesFromZZ((unsigned char *)&s[k+4], a, n);
+}
+
+void WriteBinary(std::string& s, const EE& a) {
+    WriteBinary(s, a.x);
+    WriteBinary(s, a.y);
+}
+
+template<class T>
+void WriteFactor(std::string& s, const Vec<Pair<T, long> >& f) {
+    PutWord(s, f.length(), 4);
+    for(long i=0; i<f.length(); i++) {
+        WriteBinary(s, f[i].a);
+        PutWord(s, f[i].b, 8);
+    }
+}
+
+void WriteBinary(std::string& s, const Vec<Pair<EE, long> >& f)
+{ WriteFactor(s,f); }
+
+void WriteBinary(std::string& s, const Vec<Pair<ZZ, long> >& f)
+{ WriteFactor(s,f); }
+
+static long SkipZZ(const unsigned char *& p, const unsigned char *end)
+// advance p over ZZ; return 0 if truncated
+{
+    if(end-p < 4) return 0;
+    unsigned long n(GetWord(p,4)>>1);
+    if((unsigned long)(end-p-4) < n) return 0;
+    p += 4+n;
+    return 1;
+}
+
+long ReadBinary(ZZ& a, const unsigned char *& p, const unsigned char *end) {
+    const unsigned char *q(p);
+    if(!SkipZZ(q,end)) return 0;
+    unsigned long h(GetWord(p,4));
+    ZZFromBytes(a, p+4, h>>1);
+    if(h&1) negate(a,a);
+    p = q;
+    return 1;
+}
+
+long ReadBinary(EE& a, const unsigned char *& p, const unsigned char *end) {
+    const unsigned char *q(p);
+    if(!SkipZZ(q,end) || !SkipZZ(q,end)) return 0;
+    ReadBinary(a.x, p, end);
+    ReadBinary(a.y, p, end);
+    return 1;
+}
+
+static long SkipFactor(const unsigned char *& p, const unsigned char *end,
+                       long m)
+// advance p over factorization whose primes are m ZZ's;
+// return 0 if truncated
+{
+    const unsigned char *q(p);
+    if(end-q < 4) return 0;
+    unsigned long i,k(GetWord(q,4));
+    q += 4;
+    for(i=0; i<k; i++) {
+        for(long j=0; j<m; j++) if(!SkipZZ(q,end)) return 0;
+        if(end-q < 8) return 0;
+        q += 8;
+    }
+    p = q;
+    return 1;
+}
+
+template<class T>
+long ReadFactor(Vec<Pair<T, long> >& f,
+                const unsigned char *& p, const unsigned char *end, long m)
+{
+    const unsigned char *q(p);
+    if(!SkipFactor(q,end,m)) return 0;
+    f.SetLength(GetWord(p,4));
+    p += 4;
+    for(long i=0; i<f.length(); i++) {
+        ReadBinary(f[i].a, p, end);
+        f[i].b = GetWord(p,8);
+        p += 8;
+    }
+    return 1;
+}
+
+long ReadBinary(Vec<Pair<EE, long> >& f,
+                const unsigned char *& p, const unsigned char *end)
+{ return ReadFactor(f,p,end,2); }
+
+long ReadBinary(Vec<Pair<ZZ, long> >& f,
+                const unsigned char *& p, const unsigned char *end)
+{ return ReadFactor(f,p,end,1); }
+
+EEWriter::EEWriter(std::ostream& s_, long type_)
+: s(&s_), type(type_), count(0) {
+    pos = s->tellp();
+    buf.append(EEIO_MAGIC, 4);
+    PutWord(buf, EEIO_VERSION, 2);
+    PutWord(buf, type, 2);
+    PutWord(buf, 0, 8);
+    flush();
+}
+
+#define EEWRITER_PUT(T, TYPE) \
+void EEWriter::put(const T& a) { \
+    if(type != TYPE) Error("EEWriter: wrong type"); \
+    WriteBinary(buf, a); \
+    count++; \
+    if(buf.size() >= EEIO_BUFFER) flush(); \
+}
+
+EEWRITER_PUT(ZZ, EEIO_ZZ)
+EEWRITER_PUT(EE, EEIO_EE)
+EEWRITER_PUT(vec_pair_EE_long, EEIO_FACTOR)
+EEWRITER_PUT(vec_pair_ZZ_long, EEIO_ZZFACTOR)
+
+void EEWriter::flush() {
+    if(!s) return;
+    s->write(buf.data(), buf.size());
+    if(!*s) Error("EEWriter: write failed");
+    buf.clear();
+}
+
+void EEWriter::close() {
+    if(!s) return;
+    flush();
+    if(pos != std::streampos(-1)) {
+        std::streampos e(s->tellp());
+        PutWord(buf, count, 8);
+        s->seekp(pos + std::streamoff(8));
+        s->write(buf.data(), 8);
+        s->seekp(e);
+        buf.clear();
+    }
+    s->flush();
+    s = 0;
+}
+
+EEWriter::~EEWriter() {
+    try { close(); }
+    catch(...) {// destructor must not throw
+        std::cerr << "EEWriter: write failed in destructor" << std::endl;
+        s = 0;
+    }
+}
+
+EEMap::EEMap(const char *file, long type_) {
+    struct stat st;
+    int fd(open(file, O_RDONLY));
+    if(fd < 0) Error("EEMap: cannot open file");
+    if(fstat(fd, &st) < 0 || st.st_size < EEIO_HEADER) {
+        ::close(fd);
+        Error("EEMap: not EE binary file");
+    }
+    size = st.st_size;
+    addr = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED) Error("EEMap: mmap failed");
+    madvise(addr, size, MADV_SEQUENTIAL);
+    begin = (const unsigned char *)addr;
+    end = begin + size;
+    version = GetWord(begin+4, 2);
+    type = GetWord(begin+6, 2);
+    count = GetWord(begin+8, 8);
+    if(memcmp(begin, EEIO_MAGIC, 4) != 0 ||
+       version > EEIO_VERSION || type != type_) {
+        munmap(addr, size);
+        Error("EEMap: not EE binary file of given type");
+    }
+    begin += EEIO_HEADER;
+    p = begin;
+}
+
+EEMap::~EEMap() { munmap(addr, size); }
+
+#define EEMAP_GET(T, TYPE) \
+long EEMap::get(T& a) { \
+    if(type != TYPE) Error("EEMap: wrong type"); \
+    if(p == end) return 0; \
+    if(!ReadBinary(a, p, end)) Error("EEMap: truncated record"); \
+    return 1; \
+}
+
+EEMAP_GET(ZZ, EEIO_ZZ)
+EEMAP_GET(EE, EEIO_EE)
+EEMAP_GET(vec_pair_EE_long, EEIO_FACTOR)
+EEMAP_GET(vec_pair_ZZ_long, EEIO_ZZFACTOR)
+
+long EEMap::skip() {
+    long r;
+    if(p == end) return 0;
+    if(type == EEIO_ZZ) r = SkipZZ(p,end);
+    else if(type == EEIO_EE) r = SkipZZ(p,end) && SkipZZ(p,end);
+    else if(type == EEIO_FACTOR) r = SkipFactor(p,end,2);
+    else r = SkipFactor(p,end,1);
+    if(!r) Error("EEMap: truncated record");
+    return 1;
+}
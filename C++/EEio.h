@@ -0,0 +1,88 @@
+// binary storage of ZZ, EE and factorizations
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __EEio_h__
+#define __EEio_h__
+
+#include<NTL/pair.h>
+#include<iostream>
+#include<string>
+#include "EE.h"
+
+// file = header + records of the same type
+// header (16 bytes):
+//   magic "EEb\032", version (2 bytes), type (2 bytes),
+//   number of records (8 bytes, 0 if unknown)
+// all integers are little endian
+// record of type
+//   EEIO_ZZ     : ZZ = 4 bytes (n<<1 | sign) + n bytes of |a|
+//   EEIO_EE     : ZZ x, ZZ y
+//   EEIO_FACTOR : 4 bytes k + k * (EE prime, 8 bytes exponent)
+//   EEIO_ZZFACTOR : 4 bytes k + k * (ZZ prime, 8 bytes exponent)
+#define EEIO_VERSION  1
+#define EEIO_HEADER   16
+#define EEIO_ZZ       0
+#define EEIO_EE       1
+#define EEIO_FACTOR   2
+#define EEIO_ZZFACTOR 3
+
+void WriteBinary(std::string& s, const ZZ& a);
+void WriteBinary(std::string& s, const EE& a);
+void WriteBinary(std::string& s, const Vec<Pair<EE, long> >& f);
+void WriteBinary(std::string& s, const Vec<Pair<ZZ, long> >& f);
+// append record to s
+
+long ReadBinary(ZZ& a, const unsigned char *& p, const unsigned char *end);
+long ReadBinary(EE& a, const unsigned char *& p, const unsigned char *end);
+long ReadBinary(Vec<Pair<EE, long> >& f,
+                const unsigned char *& p, const unsigned char *end);
+long ReadBinary(Vec<Pair<ZZ, long> >& f,
+                const unsigned char *& p, const unsigned char *end);
+// read record from [p,end) and advance p
+// return 0 if record is truncated, and p is unchanged
+
+struct EEWriter {
+    // streaming writer of records of one type
+    // records are buffered and written to s in blocks
+    std::ostream *s;
+    std::string buf;
+    long type, count;
+    std::streampos pos;// position of header (-1 if not seekable)
+    EEWriter(std::ostream& s, long type);// write header
+    ~EEWriter();// close, but errors are only reported to std::cerr
+    void put(const ZZ& a);
+    void put(const EE& a);
+    void put(const Vec<Pair<EE, long> >& f);
+    void put(const Vec<Pair<ZZ, long> >& f);
+    // type of argument must agree with type of writer
+    void flush();
+    void close();
+    // flush and, if s is seekable, write count to header
+    // Error if write fails; call close explicitly to detect it
+};
+
+struct EEMap {
+    // reader of records in memory mapped file
+    // records are decoded directly from mapped pages
+    const unsigned char *begin,*end;// records
+    const unsigned char *p;// next record
+    long type, version, count;// from header
+    void *addr;// mapped address
+    size_t size;// mapped size
+    EEMap(const char *file, long type);// Error if not valid
+    ~EEMap();
+    long get(ZZ& a);
+    long get(EE& a);
+    long get(Vec<Pair<EE, long> >& f);
+    long get(Vec<Pair<ZZ, long> >& f);
+    // read next record; return 0 at end of file
+    long skip();
+    // skip next record without decoding; return 0 at end of file
+    void rewind() { p = begin; }
+private:
+    EEMap(const EEMap&);
+    EEMap& operator=(const EEMap&);
+};
+
+#endif // __EEio_h__
@@ -0,0 +1,340 @@
+// python extension module _EE (used by EE.py)
+// uses NTL
+//   http://www.shoup.net/ntl
+// Eisenstein integers are passed as (x,y) tuples, ints,
+// or objects with attributes x and y (such as EE.EE),
+// and are returned as (x,y) tuples
+// batch functions take sequences of them
+// or buffers of 64-bit integers x0,y0,x1,y1,...,
+// and run without GIL using NTL thread pool (see SetNumThreads)
+
+#define PY_SSIZE_T_CLEAN
+#include<Python.h>
+#include<NTL/BasicThreadPool.h>
+#include "EEFactoring.h"
+using namespace NTL;
+
+#define EE_TRY(s) \
+    try { s } \
+    catch(std::exception& e) { \
+        PyErr_SetString(PyExc_RuntimeError, e.what()); \
+        return 0; \
+    }
+
+static int ToZZ(ZZ& a, PyObject *o)
+// a = python int o; return 0 if o is not int
+{
+    int v;
+    long long l;
+    if(!PyLong_Check(o)) {
+        PyErr_SetString(PyExc_TypeError, "int expected");
+        return 0;
+    }
+    l = PyLong_AsLongLongAndOverflow(o,&v);
+    if(v==0) { conv(a, long(l)); return 1; }
+    PyObject *b(PyNumber_Absolute(o)), *n(0), *s(0);
+    if(b) n = PyObject_CallMethod(b, "bit_length", 0);
+    if(n) s = PyObject_CallMethod(b, "to_bytes", "ns",
+                                  (PyLong_AsSsize_t(n)+7)>>3, "little");
+    if(s) {
+        ZZFromBytes(a, (const unsigned char*)PyBytes_AS_STRING(s),
+                    PyBytes_GET_SIZE(s));
+        if(v<0) negate(a,a);
+    }
+    Py_XDECREF(b);
+    Py_XDECREF(n);
+    Py_XDECREF(s);
+    return s != 0;
+}
+
+static PyObject *FromZZ(const ZZ& a)
+// return python int equal to a
+{
+    if(NumBits(a) < NTL_BITS_PER_LONG) return PyLong_FromLong(to_long(a));
+    long n(NumBytes(a));
+    Vec<unsigned char> b;
+    b.SetLength(n);
+    BytesFromZZ(b.elts(), a, n);
+    PyObject *r(PyObject_CallMethod((PyObject*)&PyLong_Type, "from_bytes",
+                                    "y#s", b.elts(), Py_ssize_t(n), "little"));
+    if(r && sign(a)<0) {
+        PyObject *s(PyNumber_Negative(r));
+        Py_DECREF(r);
+        r = s;
+    }
+    return r;
+}
+
+static int ToEE(EE& a, PyObject *o)
+// a = o given as int, (x,y) or object with attributes x,y
+// return 0 if o is none of them
+{
+    if(PyLong_Check(o)) { clear(a.y); return ToZZ(a.x,o); }
+    if(PyTuple_Check(o) && PyTuple_GET_SIZE(o)==2)
+        return ToZZ(a.x, PyTuple_GET_ITEM(o,0)) &&
+               ToZZ(a.y, PyTuple_GET_ITEM(o,1));
+    PyObject *x(PyObject_GetAttrString(o,"x")), *y(0);
+    if(x) y = PyObject_GetAttrString(o,"y");
+    int r(y && ToZZ(a.x,x) && ToZZ(a.y,y));
+    Py_XDECREF(x);
+    Py_XDECREF(y);
+    return r;
+}
+
+static PyObject *FromEE(const EE& a)
+// return (x,y) tuple equal to a
+{ return Py_BuildValue("(NN)", FromZZ(a.x), FromZZ(a.y)); }
+
+static int ToVecEE(Vec<EE>& a, PyObject *o)
+// a = sequence of Eisenstein integers or buffer of 64-bit pairs
+{
+    long i,n;
+    if(PyObject_CheckBuffer(o)) {
+        Py_buffer v;
+        if(PyObject_GetBuffer(o, &v, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS))
+            return 0;
+        const char *f(v.format ? v.format : "B");
+        if(*f=='@' || *f=='=') f++;// native byte order
+        if(v.itemsize != 8 || v.len % 16 ||
+           (*f!='q' && *f!='l') || f[1]) {// signed only
+            PyBuffer_Release(&v);
+            PyErr_SetString(PyExc_TypeError, "buffer of int64 pairs expected");
+            return 0;
+        }
+        const long long *p((const long long*)v.buf);
+        n = v.len/16;
+        a.SetLength(n);
+        for(i=0; i<n; i++) set(a[i], long(p[i<<1]), long(p[i<<1|1]));
+        PyBuffer_Release(&v);
+        return 1;
+    }
+    PyObject *s(PySequence_Fast(o, "sequence expected"));
+    if(!s) return 0;
+    n = PySequence_Fast_GET_SIZE(s);
+    a.SetLength(n);
+    for(i=0; i<n; i++)
+        if(!ToEE(a[i], PySequence_Fast_GET_ITEM(s,i))) break;
+    Py_DECREF(s);
+    return i==n;
+}
+
+static PyObject *FromVecEE(const Vec<EE>& a)
+// return list of (x,y) tuples
+{
+    PyObject *r(PyList_New(a.length()));
+    for(long i=0; r && i<a.length(); i++) {
+        PyObject *t(FromEE(a[i]));
+        if(!t) { Py_DECREF(r); return 0; }
+        PyList_SET_ITEM(r,i,t);
+    }
+    return r;
+}
+
+static PyObject *FromFactor(const Vec<Pair<EE, long> >& f)
+// return list of ((x,y),e) tuples
+{
+    PyObject *r(PyList_New(f.length()));
+    for(long i=0; r && i<f.length(); i++) {
+        PyObject *t(Py_BuildValue("(Nl)", FromEE(f[i].a), f[i].b));
+        if(!t) { Py_DECREF(r); return 0; }
+        PyList_SET_ITEM(r,i,t);
+    }
+    return r;
+}
+
+static PyObject *py_GCD(PyObject *, PyObject *args)
+{
+    PyObject *a,*b;
+    EE x,y,d;
+    if(!PyArg_ParseTuple(args, "OO", &a, &b) ||
+       !ToEE(x,a) || !ToEE(y,b)) return 0;
+    EE_TRY( GCD(d,x,y); )
+    return FromEE(d);
+}
+
+static PyObject *py_XGCD(PyObject *, PyObject *args)
+{
+    PyObject *a,*b;
+    EE x,y,d,s,t;
+    if(!PyArg_ParseTuple(args, "OO", &a, &b) ||
+       !ToEE(x,a) || !ToEE(y,b)) return 0;
+    EE_TRY( XGCD(d,s,t,x,y); )
+    return Py_BuildValue("(NNN)", FromEE(d), FromEE(s), FromEE(t));
+}
+
+static PyObject *py_PowerMod(PyObject *, PyObject *args)
+{
+    PyObject *a,*k,*n;
+    EE x,m,b;
+    ZZ e;
+    if(!PyArg_ParseTuple(args, "OOO", &a, &k, &n) ||
+       !ToEE(x,a) || !ToZZ(e,k) || !ToEE(m,n)) return 0;
+    EE_TRY( PowerMod(b,x,e,m); )
+    return FromEE(b);
+}
+
+static PyObject *py_ResSymb(PyObject *, PyObject *args)
+{
+    PyObject *a,*b;
+    EE x,y,s;
+    if(!PyArg_ParseTuple(args, "OO", &a, &b) ||
+       !ToEE(x,a) || !ToEE(y,b)) return 0;
+    EE_TRY( ResSymb(s,x,y); )
+    return FromEE(s);
+}
+
+static PyObject *py_CubRootMod(PyObject *, PyObject *args)
+{
+    PyObject *a,*b;
+    EE x,p,r;
+    if(!PyArg_ParseTuple(args, "OO", &a, &b) ||
+       !ToEE(x,a) || !ToEE(p,b)) return 0;
+    EE_TRY( CubRootMod(r,x,p); )
+    return FromEE(r);
+}
+
+static PyObject *py_FactorPrime(PyObject *, PyObject *args)
+{
+    PyObject *a;
+    ZZ p;
+    EE f;
+    if(!PyArg_ParseTuple(args, "O", &a) || !ToZZ(p,a)) return 0;
+    EE_TRY( FactorPrime(f,p); )
+    return FromEE(f);
+}
+
+static PyObject *py_factor(PyObject *, PyObject *args)
+{
+    PyObject *a;
+    EE x;
+    Vec<Pair<EE, long> > f;
+    if(!PyArg_ParseTuple(args, "O", &a) || !ToEE(x,a)) return 0;
+    EE_TRY( factor(f,x); )
+    return FromFactor(f);
+}
+
+static PyObject *py_IsPrime(PyObject *, PyObject *args)
+{
+    PyObject *a;
+    EE x;
+    long r;
+    if(!PyArg_ParseTuple(args, "O", &a) || !ToEE(x,a)) return 0;
+    EE_TRY( r = ProbPrime(x); )
+    return PyBool_FromLong(r);
+}
+
+static PyObject *py_GenPrime(PyObject *, PyObject *args)
+{
+    long l,f(1);
+    EE p;
+    if(!PyArg_ParseTuple(args, "l|l", &l, &f)) return 0;
+    EE_TRY( GenPrime(p,l,f); )
+    return FromEE(p);
+}
+
+static PyObject *py_SetNumThreads(PyObject *, PyObject *args)
+{
+    long n;
+    if(!PyArg_ParseTuple(args, "l", &n)) return 0;
+    EE_TRY( SetNumThreads(n); )
+    Py_RETURN_NONE;
+}
+
+// batch functions
+//   computed in parallel after releasing GIL
+//   first error (if any) is raised after all are done
+
+#define EE_BATCH(n, i, s) { \
+    std::string err_; \
+    Py_BEGIN_ALLOW_THREADS \
+    try { \
+        NTL_EXEC_RANGE(n, first_, last_) \
+        for(long i=first_; i<last_; i++) { s } \
+        NTL_EXEC_RANGE_END \
+    } \
+    catch(std::exception& e) { err_ = e.what(); } \
+    Py_END_ALLOW_THREADS \
+    if(!err_.empty()) { \
+        PyErr_SetString(PyExc_RuntimeError, err_.c_str()); \
+        return 0; \
+    } \
+}
+
+static PyObject *py_ResSymbBatch(PyObject *, PyObject *args)
+{
+    PyObject *a,*b;
+    EE p;
+    Vec<EE> x,s;
+    if(!PyArg_ParseTuple(args, "OO", &a, &b) ||
+       !ToVecEE(x,a) || !ToEE(p,b)) return 0;
+    s.SetLength(x.length());
+    EE_BATCH(x.length(), i, ResSymb(s[i],x[i],p);)
+    return FromVecEE(s);
+}
+
+static PyObject *py_CubRootModBatch(PyObject *, PyObject *args)
+{
+    PyObject *a,*b;
+    EE p;
+    Vec<EE> x;
+    if(!PyArg_ParseTuple(args, "OO", &a, &b) ||
+       !ToVecEE(x,a) || !ToEE(p,b)) return 0;
+    EE_BATCH(1, i, CubRootMod(x,x,p);)
+    return FromVecEE(x);
+}
+
+static PyObject *py_factorBatch(PyObject *, PyObject *args)
+{
+    PyObject *a,*r;
+    Vec<EE> x;
+    Vec<Vec<Pair<EE, long> > > f;
+    if(!PyArg_ParseTuple(args, "O", &a) || !ToVecEE(x,a)) return 0;
+    f.SetLength(x.length());
+    EE_BATCH(x.length(), i, factor(f[i],x[i]);)
+    if(!(r = PyList_New(f.length()))) return 0;
+    for(long i=0; i<f.length(); i++) {
+        PyObject *t(FromFactor(f[i]));
+        if(!t) { Py_DECREF(r); return 0; }
+        PyList_SET_ITEM(r,i,t);
+    }
+    return r;
+}
+
+static PyObject *py_IsPrimeBatch(PyObject *, PyObject *args)
+{
+    PyObject *a,*r;
+    Vec<EE> x;
+    Vec<long> t;
+    if(!PyArg_ParseTuple(args, "O", &a) || !ToVecEE(x,a)) return 0;
+    t.SetLength(x.length());
+    EE_BATCH(x.length(), i, t[i] = ProbPrime(x[i]);)
+    if(!(r = PyList_New(t.length()))) return 0;
+    for(long i=0; i<t.length(); i++)
+        PyList_SET_ITEM(r, i, PyBool_FromLong(t[i]));
+    return r;
+}
+
+static PyMethodDef EEMethods[] = {
+    {"GCD", py_GCD, METH_VARARGS, "GCD(a,b) -> d"},
+    {"XGCD", py_XGCD, METH_VARARGS, "XGCD(a,b) -> (d,s,t), d = s*a + t*b"},
+    {"PowerMod", py_PowerMod, METH_VARARGS, "PowerMod(a,k,n) -> a^k mod n"},
+    {"ResSymb", py_ResSymb, METH_VARARGS, "ResSymb(a,p) -> (a/p)_3"},
+    {"CubRootMod", py_CubRootMod, METH_VARARGS, "CubRootMod(a,p) -> x, x^3 == a (mod p)"},
+    {"FactorPrime", py_FactorPrime, METH_VARARGS, "FactorPrime(p) -> primary prime of norm p"},
+    {"factor", py_factor, METH_VARARGS, "factor(a) -> [(prime, exponent), ...]"},
+    {"IsPrime", py_IsPrime, METH_VARARGS, "IsPrime(a) -> bool"},
+    {"GenPrime", py_GenPrime, METH_VARARGS, "GenPrime(l, f=1) -> random primary prime"},
+    {"SetNumThreads", py_SetNumThreads, METH_VARARGS, "SetNumThreads(n) for batch functions"},
+    {"ResSymbBatch", py_ResSymbBatch, METH_VARARGS, "ResSymbBatch(A,p) -> [(a/p)_3 for a in A]"},
+    {"CubRootModBatch", py_CubRootModBatch, METH_VARARGS, "CubRootModBatch(A,p) -> [CubRootMod(a,p) for a in A]"},
+    {"factorBatch", py_factorBatch, METH_VARARGS, "factorBatch(A) -> [factor(a) for a in A]"},
+    {"IsPrimeBatch", py_IsPrimeBatch, METH_VARARGS, "IsPrimeBatch(A) -> [IsPrime(a) for a in A]"},
+    {0, 0, 0, 0}
+};
+
+static struct PyModuleDef EEModule = {
+    PyModuleDef_HEAD_INIT, "_EE",
+    "native implementation of EE.py", -1, EEMethods
+};
+
+PyMODINIT_FUNC PyInit__EE() { return PyModule_Create(&EEModule); }
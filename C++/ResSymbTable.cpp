@@ -0,0 +1,137 @@
+#include<list>
+#include<mutex>
+#include "ResSymbTable.h"
+
+static void PrimeFactors(Vec<long>& f, long n)
+// f = distinct prime factors of n by trial division
+{
+    f.SetLength(0);
+    for(long d=2; d*d<=n; d++) {
+        if(n%d) continue;
+        f.append(d);
+        while(n%d==0) n/=d;
+    }
+    if(n>1) f.append(n);
+}
+
+static void MulMod(long& x, long& y, long u, long v, long q)
+// x+yw = (x+yw)(u+vw) mod q; assume 0 <= x,y,u,v < q
+// |intermediates| < 2q^2 <= 2*RESSYMB_TABLE_MAX since q^2 = norm of inert p
+{
+    long t((x*u - y*v)%q);
+    y = (x*v + y*u - y*v)%q;
+    x = t;
+    if(x<0) x+=q;
+    if(y<0) y+=q;
+}
+
+static void PowerMod(long& x, long& y, long u, long v, long e, long q)
+// x+yw = (u+vw)^e mod q
+{
+    x=1; y=0;
+    for(long m(1L<<NumBits(e)); m>>=1;) {
+        MulMod(x,y,x,y,q);
+        if(e&m) MulMod(x,y,u,v,q);
+    }
+}
+
+static void SetCode(Vec<unsigned char>& T, long i, long c)
+{ T[i>>2] |= c<<((i&3)<<1); }
+
+static void ClearTable(Vec<unsigned char>& T, long n)
+// T = n codes of zero
+{
+    T.SetLength((n+3)>>2);
+    for(long i=0; i<T.length(); i++) T[i] = 0;
+}
+
+ResSymbTable::ResSymbTable(const EE& a) : p(a) {
+    long i,j,k,g,t,x,y,u,v,n;
+    ZZ N;
+    Vec<long> f;
+    norm(N,p);
+    if(N <= 3 || N > RESSYMB_TABLE_MAX || !ProbPrime(p))
+        Error("ResSymbTable: invalid prime");
+    if(p.x%3 != 2 || p.y%3 != 0) Error("ResSymbTable: not primary");
+    if(IsZero(p.y)) {// inert, Z[w]/p = F_q[w]
+        q = to_long(p.x);
+        r = -1;
+        n = q*q-1;
+        ClearTable(T,q*q);
+        PrimeFactors(f,n);
+        for(k=q;; k++) {// generator u+vw
+            u = k%q; v = k/q;
+            for(i=0; i<f.length(); i++) {
+                PowerMod(x,y,u,v,n/f[i],q);
+                if(x==1 && y==0) break;
+            }
+            if(i==f.length()) break;
+        }
+        PowerMod(x,y,u,v,n/3,q);
+        j = (y==1 ? 1:2);// (u+vw)^{n/3} = w^j
+        for(i=0, x=1, y=0; i<n; i++) {
+            SetCode(T, x+y*q, 1 + i*j%3);
+            MulMod(x,y,u,v,q);
+        }
+    }
+    else {// split, Z[w]/p = F_q, w -> r
+        q = to_long(N);
+        x = rem(p.x, q);
+        y = rem(p.y, q);
+        r = MulMod(q-x, InvMod(y,q), q);
+        ClearTable(T,q);
+        PrimeFactors(f,q-1);
+        for(g=2;; g++) {
+            for(i=0; i<f.length(); i++)
+                if(PowerMod(g, (q-1)/f[i], q) == 1) break;
+            if(i==f.length()) break;
+        }
+        j = (PowerMod(g, (q-1)/3, q) == r ? 1:2);// g^{(q-1)/3} = w^j
+        for(i=0, t=1; i<q-1; i++) {
+            SetCode(T, t, 1 + i*j%3);
+            t = MulMod(t,g,q);
+        }
+    }
+}
+
+static std::mutex pool_mutex;
+static std::list<std::shared_ptr<const ResSymbTable> > pool;// LRU order
+
+void ResSymb(EE& s, const EE& a, const ResSymbTable& T)
+// s = (a/T.p)_3 = 0,1,w,w^2 by table lookup
+{
+    long c(T.code(rem(a.x, T.q), rem(a.y, T.q)));
+    if(c==0) clear(s);
+    else if(c==1) set(s);
+    else if(c==2) set(s,0,1);
+    else set(s,-1,-1);
+}
+
+std::shared_ptr<const ResSymbTable> FindResSymbTable(const EE& p)
+// return table of p if in pool, else null
+{
+    std::lock_guard<std::mutex> lk(pool_mutex);
+    for(std::list<std::shared_ptr<const ResSymbTable> >::iterator
+        i=pool.begin(); i!=pool.end(); i++) {
+        if((*i)->p != p) continue;
+        pool.splice(pool.begin(), pool, i);
+        return pool.front();
+    }
+    return std::shared_ptr<const ResSymbTable>();
+}
+
+std::shared_ptr<const ResSymbTable> GetResSymbTable(const EE& p)
+// return table of p from LRU pool shared by threads
+// tables are built without lock
+{
+    std::shared_ptr<const ResSymbTable> t(FindResSymbTable(p));
+    if(t) return t;
+    t.reset(new ResSymbTable(p));
+    std::lock_guard<std::mutex> lk(pool_mutex);
+    for(std::list<std::shared_ptr<const ResSymbTable> >::iterator
+        i=pool.begin(); i!=pool.end(); i++)// built by other thread
+        if((*i)->p == p) return *i;
+    pool.push_front(t);
+    if(pool.size() > RESSYMB_POOL_SIZE) pool.pop_back();
+    return t;
+}
@@ -0,0 +1,49 @@
+// tables of cubic residue symbols for small primes
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __ResSymbTable_h__
+#define __ResSymbTable_h__
+
+#include<memory>
+#include "EE.h"
+
+#define RESSYMB_TABLE_MAX (1<<20) // max norm of prime for table
+#define RESSYMB_POOL_SIZE 64      // max number of tables in pool
+
+struct ResSymbTable {
+    // cubic residue symbol (a/p)_3 for all residue classes a mod p
+    // where p is primary prime, 3 < norm(p) <= RESSYMB_TABLE_MAX
+    EE p;
+    long q;// norm(p) if p is split, else p = q (inert)
+    long r;// w == r (mod p) if p is split, else -1
+    Vec<unsigned char> T;// 2 bits per residue class
+    // 0: a==0 (mod p), 1: (a/p)_3 = 1, 2: w, 3: w^2
+    // built by discrete logarithms to a generator of (Z[w]/p)^*
+    explicit ResSymbTable(const EE& p);// Error if p is not valid
+    long index(long x, long y) const {// index of x+yw mod p
+        x%=q; if(x<0) x+=q;
+        y%=q; if(y<0) y+=q;
+        return r<0 ? x + y*q : (x + y*r)%q;
+    }
+    long code(long x, long y) const {// 0,1,2,3 for x+yw as above
+        long i(index(x,y));
+        return T[i>>2]>>((i&3)<<1) & 3;
+    }
+};
+
+void ResSymb(EE& s, const EE& a, const ResSymbTable& T);
+// s = (a/T.p)_3 = 0,1,w,w^2 by table lookup
+// a may be any Eisenstein integer
+
+std::shared_ptr<const ResSymbTable> FindResSymbTable(const EE& p);
+// return table of p if it is in pool, else null
+
+std::shared_ptr<const ResSymbTable> GetResSymbTable(const EE& p);
+// return table of p from pool shared by threads
+// table is built if not found, and least recently used table
+// is discarded if pool has more than RESSYMB_POOL_SIZE tables
+// ResSymb(s,a,b) in EE.h never looks up pool; callers hold the table
+//   returned here and call ResSymb(s,a,T) above for each a
+
+#endif // __ResSymbTable_h__
@@ -0,0 +1,110 @@
+#include<NTL/BasicThreadPool.h>
+#include "EE.h"
+
+#define TRACE_SEGMENT (1<<17) // odd numbers per segment (bytes)
+#define TRACE_BATCH   4       // segments per thread in parallel
+
+static long trace(long d, long p)
+// word-size version of TraceFrob below; d = 4D mod p
+// Assume p is prime, 3 < p < NTL_SP_BOUND
+{
+    long x,y,r,s,t,j;
+    if(d==0 || p%3 == 2) return 0;
+    FactorPrime(x,y,p);
+    r = MulMod((p - x%p)%p, InvMod((y%p+p)%p, p), p);// w == r (mod pi)
+    s = PowerMod(d, (p-1)/6, p);
+    for(j=0, t=1; t!=s; j++) t = MulMod(t, r+1, p);// s == (1+w)^j
+    for(j=(6-j)%6; j>0; j--) { t=x; x-=y; y=t; }// pi * (1+w)^{-j}
+    return y - 2*x;
+}
+
+void TraceFrob(ZZ& a, const ZZ& D, const ZZ& p)
+// (4D/pi)_6 = (1+w)^j is found by
+//   (4D)^{(p-1)/6} == (1+r)^j (mod p) where w == r (mod pi)
+// reference:
+//   K. Ireland and M. Rosen "A Classical Introduction to
+//     Modern Number Theory" 2nd edition (Springer) section 18.3
+{
+    if(p <= 3) Error("TraceFrob: p must be > 3");
+    if(p < NTL_SP_BOUND) {
+        a = trace(rem(D<<2, to_long(p)), to_long(p));
+        return;
+    }
+    long j;
+    ZZ d,r,s,t,u;
+    EE pi;
+    rem(d, D<<2, p);
+    if(IsZero(d) || p%3 == 2) { clear(a); return; }
+    FactorPrime(pi, p);
+    rem(r, -pi.x, p);
+    rem(t, pi.y, p);
+    InvMod(t, t, p);
+    MulMod(r, r, t, p);
+    add(u, r, 1);
+    div(t, p-1, 6);
+    PowerMod(s, d, t, p);
+    for(j=0, set(t); t!=s; j++) MulMod(t, t, u, p);
+    rot60(pi, pi, 6-j);
+    sub(a, pi.y, pi.x);
+    a -= pi.x;
+}
+
+static void TraceSegment(Vec<long>& r, long lo, long hi, long P0,
+                         const ZZ& E, const Vec<long>& q)
+// r = p,a_p,p,a_p,... for primes p >= P0, lo <= p < hi
+// E = 4D, q = odd primes up to sqrt(hi)
+// assume lo is even and P0 >= 5
+{
+    long i,j,n,m((hi-lo)>>1);
+    Vec<char> sv;
+    sv.SetLength(m);
+    for(i=0; i<m; i++) sv[i] = 1;
+    for(i=0; i<q.length() && q[i]*q[i] < hi; i++) {
+        n = (lo + q[i]-1)/q[i]*q[i];
+        if(n < q[i]*q[i]) n = q[i]*q[i];
+        if((n&1)==0) n += q[i];
+        for(j=(n-lo)>>1; j<m; j+=q[i]) sv[j] = 0;
+    }
+    r.SetLength(0);
+    for(i=0; i<m; i++) {
+        n = lo + (i<<1) + 1;
+        if(!sv[i] || n < P0) continue;
+        r.append(n);
+        r.append(trace(rem(E,n), n));
+    }
+}
+
+void TraceFrob(const ZZ& D, long P0, long P1,
+               const std::function<void(long, long)>& f)
+// primes are sieved in segments and a_p are computed in parallel
+{
+    if(P1 > NTL_SP_BOUND) Error("P1 too large in TraceFrob");
+    if(P0 < 5) P0 = 5;
+    if(P0 >= P1) return;
+    long i,k,l,n,b,lo(P0 & ~1L),sn(SqrRoot(P1));
+    ZZ E(D<<2);
+    Vec<long> q;
+    Vec<Vec<long> > r;
+    PrimeSeq ps;
+    while((i = ps.next()) <= sn) {
+        if(i==0) Error("P1 too large in TraceFrob");
+        if(i>2) q.append(i);
+    }
+    b = AvailableThreads()*TRACE_BATCH;
+    r.SetLength(b);
+    while(lo < P1) {
+        l = 2*TRACE_SEGMENT;
+        n = (P1 - lo + l-1)/l;
+        if(n > b) n = b;
+        NTL_EXEC_RANGE(n, first, last)
+        for(long j=first; j<last; j++) {
+            long u(lo + j*l), v(u+l);
+            if(v > P1) v = P1;
+            TraceSegment(r[j], u, v, P0, E, q);
+        }
+        NTL_EXEC_RANGE_END
+        for(i=0; i<n; i++)
+            for(k=0; k<r[i].length(); k+=2) f(r[i][k], r[i][k+1]);
+        lo += n*l;
+    }
+}
@@ -1,21 +1,93 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
-#include<NTL/ZZ.h>
-#include<NTL/pair.h>
+#include "ZZFactoring.h"
 using namespace NTL;
 
 #define TRYDIV_BOUND (1<<16)
-#define MR_NUM_TRIAL 20
 #define RHO_TIME_OUT 5
+#define PM1_B1   20000   // default bounds of p-1
+#define PM1_B2   2000000
+#define PP1_B1   10000   // default bounds of p+1
+#define PP1_B2   1000000
+#define PP1_SEEDS 2
+#define PM1_BITS 80      // p-1 and p+1 are tried for n of 80 bits or more
+
+long BPSW(const ZZ&);
+
+static thread_local FactorStats *factor_stats(0);
+static thread_local FactorParams factor_params;
+
+FactorParams::FactorParams()
+: pm1_B1(PM1_B1), pm1_B2(PM1_B2), pp1_B1(PP1_B1), pp1_B2(PP1_B2),
+  pp1_seeds(PP1_SEEDS), pm1_bits(PM1_BITS), rho_time(RHO_TIME_OUT),
+  mpqs_workers(0) {;}
+
+void SetFactorParams(const FactorParams& p) { factor_params = p; }
+const FactorParams& GetFactorParams() { return factor_params; }
+
+void SetFactorStats(FactorStats *s) { factor_stats = s; }
+
+#ifndef NO_FACTOR_STATS
+FactorStats *GetFactorStats() { return factor_stats; }
+#endif
+
+void FactorStats::clear() {
+    t_trydiv = t_prime = t_rho = t_pm1 = t_pp1 = t_squfof = 0;
+    t_base = t_sieve = t_trial = t_kernel = 0;
+    rho_calls = rho_iter = rho_fail = 0;
+    pm1_calls = pm1_stage2 = pp1_calls = pp1_stage2 = 0;
+    squfof_calls = squfof_rho = 0;
+    mpqs_calls = mpqs_base = mpqs_poly = mpqs_rel = 0;
+    mpqs_rows = mpqs_cols = 0;
+    found.SetLength(0);
+}
+
+void WriteJSON(std::ostream& s, const FactorStats& a)
+// output a to s in JSON format
+{
+    static const char *method[] =
+        {"trydiv", "prime", "rho", "mpqs", "pm1", "pp1", "power", "squfof"};
+    s << "{\"time\": {\"trydiv\": " << a.t_trydiv
+      << ", \"prime\": " << a.t_prime
+      << ", \"pm1\": " << a.t_pm1
+      << ", \"pp1\": " << a.t_pp1
+      << ", \"squfof\": " << a.t_squfof
+      << ", \"rho\": " << a.t_rho
+      << ", \"mpqs_base\": " << a.t_base
+      << ", \"mpqs_sieve\": " << a.t_sieve
+      << ", \"mpqs_trial\": " << a.t_trial
+      << ", \"mpqs_kernel\": " << a.t_kernel << "},\n"
+      << " \"pm1\": {\"calls\": " << a.pm1_calls
+      << ", \"stage2\": " << a.pm1_stage2 << "},\n"
+      << " \"pp1\": {\"calls\": " << a.pp1_calls
+      << ", \"stage2\": " << a.pp1_stage2 << "},\n"
+      << " \"squfof\": {\"calls\": " << a.squfof_calls
+      << ", \"rho\": " << a.squfof_rho << "},\n"
+      << " \"rho\": {\"calls\": " << a.rho_calls
+      << ", \"iterations\": " << a.rho_iter
+      << ", \"timeouts\": " << a.rho_fail << "},\n"
+      << " \"mpqs\": {\"calls\": " << a.mpqs_calls
+      << ", \"base\": " << a.mpqs_base
+      << ", \"polynomials\": " << a.mpqs_poly
+      << ", \"relations\": " << a.mpqs_rel
+      << ", \"rows\": " << a.mpqs_rows
+      << ", \"cols\": " << a.mpqs_cols << "},\n"
+      << " \"found\": [";
+    for(long i=0; i<a.found.length(); i++)
+        s << (i ? ", " : "") << "{\"factor\": \"" << a.found[i].a
+          << "\", \"method\": \"" << method[a.found[i].b] << "\"}";
+    s << "]}";
+}
 
 long IsPrimePower(ZZ& p, const ZZ& n, long N)
 // input:
 //   n = odd integer, n>=3
 //   N = number of times to perform Miller-Rabin test
+//       if N<=0, primality is tested by BPSW
 // output:
 //   p = prime factor of n if n = p^k (k>=1)
-//       with error probability < 4^{-N}
+//       with error probability < 4^{-N} (if N>0)
 // return:
 //   k if n = p^k (k>=1)
 //   0 otherwise
@@ -23,11 +95,17 @@ long IsPrimePower(ZZ& p, const ZZ& n, long N)
     long i;
     ZZ a,d;
     for(p=n;; p=d) {
-        for(i=0; i<N; i++) {
-            RandomBnd(a,p);
-            if(MillerWitness(p,a)) break;
+        if(N<=0) {
+            if(BPSW(p)) break;
+            do RandomBnd(a,p); while(!MillerWitness(p,a));
+        }
+        else {
+            for(i=0; i<N; i++) {
+                RandomBnd(a,p);
+                if(MillerWitness(p,a)) break;
+            }
+            if(i==N) break;
         }
-        if(i==N) break;
         PowerMod(d,a,p,p);
         d -= a;
         GCD(d,d,p);
@@ -38,27 +116,107 @@ long IsPrimePower(ZZ& p, const ZZ& n, long N)
     return (IsOne(d) ? i:0);
 }
 
+static void root(ZZ& r, const ZZ& n, long k)
+// r = floor of k-th root of n by Newton's method; assume n>=1, k>=2
+{
+    ZZ x,y,t;
+    set(x);
+    x <<= (NumBits(n)+k-1)/k;// x >= root
+    for(;;) {
+        power(t, x, k-1);
+        div(t, n, t);
+        mul(y, x, k-1);
+        add(y, y, t);
+        div(y, y, k);
+        if(y >= x) break;
+        x = y;
+    }
+    r = x;
+}
+
+long IsPerfectPower(ZZ& m, const ZZ& n, long b)
+// input:
+//   n = integer, n>=2
+//   b = lower bound of prime factors of n, b>=2
+// output:
+//   m = integer such that n = m^k, m is not perfect power
+// return:
+//   k if k>=2, else 0
+// k-th roots are computed only for primes k such that b^k <= n
+{
+    long k(1),p;
+    ZZ r,t;
+    PrimeSeq ps;
+    p = ps.next();
+    for(m=n; p*(NumBits(b)-1) < NumBits(m);) {// b^p <= m
+        if(p==2) SqrRoot(r,m);
+        else root(r,m,p);
+        power(t,r,p);
+        if(t==m) {
+            m = r;
+            k *= p;
+        }
+        else p = ps.next();
+    }
+    return k>1 ? k:0;
+}
+
 long brent_rho(ZZ&, const ZZ&, double);
 long mpqs(ZZ&, const ZZ&);
+long pm1(ZZ&, const ZZ&, long, long);
+long pp1(ZZ&, const ZZ&, long, long, long);
+long IsPrime64(unsigned long);
+long IsPerfectPower(long&, long, long);
+long squfof(long&, long);
 
 void factor_(Vec<Pair<ZZ, long> >& f, const ZZ& n)
 // input:
 //   n = odd, integer, n>=3
+//       with no prime factors <= TRYDIV_BOUND
 // output:
 //   f = prime factorization of n (appended to f)
+// n < NTL_SP_BOUND is factored by word size arithmetic
 {
-    long i,j,k(f.length());
+    long i,j,k(f.length()),m,a,b,w(n < NTL_SP_BOUND);
     ZZ p,q;
-    if(j = IsPrimePower(p, n, MR_NUM_TRIAL)) {
+    FactorStats *st(GetFactorStats());
+    double t;
+    if(w) a = to_long(n);
+    if(st) t = GetTime();
+    if(w) { j = IsPrime64(a); p = a; }
+    else j = IsPrimePower(p, n, 0);// BPSW
+    if(st) st->t_prime += GetTime() - t;
+    if(j) {
         f.SetLength(k+1);
         f[k].a = p;
         f[k].b = j;
+        if(st) st->found.append(cons(p, long(FACTOR_PRIME)));
         return;
     }
     Vec<Pair<ZZ, long> > g,h;
-    if(brent_rho(p, n, RHO_TIME_OUT) == 0);
-    else if(mpqs(p,n) == 0);
+    if(w) { m = IsPerfectPower(b, a, TRYDIV_BOUND); p = b; }
+    else m = IsPerfectPower(p, n, TRYDIV_BOUND);
+    if(m) {// n = p^m
+        if(st) st->found.append(cons(p, long(FACTOR_POWER)));
+        factor_(g,p);
+        f.SetLength(k + g.length());
+        for(i=0; i<g.length(); i++) {
+            f[k+i] = g[i];
+            f[k+i].b *= m;
+        }
+        return;
+    }
+    const FactorParams& P(GetFactorParams());
+    if(w && squfof(b,a) == 0) { p = b; m = FACTOR_SQUFOF; }
+    else if(NumBits(n) >= P.pm1_bits && P.pm1_B1 > 0 &&
+       pm1(p, n, P.pm1_B1, P.pm1_B2) == 0) m = FACTOR_PM1;
+    else if(NumBits(n) >= P.pm1_bits && P.pp1_B1 > 0 &&
+            pp1(p, n, P.pp1_B1, P.pp1_B2, P.pp1_seeds) == 0) m = FACTOR_PP1;
+    else if(brent_rho(p, n, P.rho_time) == 0) m = FACTOR_RHO;
+    else if((P.mpqs_workers > 0 ? mpqs(p, n, P.mpqs_workers) : mpqs(p,n)) == 0)
+        m = FACTOR_MPQS;
     else Error("factor not found");
+    if(st) st->found.append(cons(p,m));
     div(q,n,p);
     factor_(g,p);
     factor_(h,q);
@@ -85,26 +243,31 @@ void factor(Vec<Pair<ZZ, long> >& f, const ZZ& n)
 {
     long i(0),j,p;
     ZZ m;
+    FactorStats *st(GetFactorStats());
+    double t;
     abs(m,n);
     f.SetLength(0);
     if(IsZero(m) || IsOne(m)) return;
+    if(st) t = GetTime();
     if(j = MakeOdd(m)) {
         f.SetLength(1);
         f[0].a = 2;
         f[0].b = j;
-        if(IsOne(m)) return;
         i++;
     }
     PrimeSeq ps;
     ps.reset(3);
-    while((p = ps.next()) <= TRYDIV_BOUND) {
+    while(!IsOne(m) && (p = ps.next()) <= TRYDIV_BOUND) {
         for(j=0; divide(m,m,p); j++);
         if(j==0) continue;
         f.SetLength(i+1);
         f[i].a = p;
         f[i].b = j;
-        if(IsOne(m)) return;
         i++;
     }
-    factor_(f,m);
+    if(st) {
+        st->t_trydiv += GetTime() - t;
+        for(j=0; j<i; j++) st->found.append(cons(f[j].a, long(FACTOR_TRYDIV)));
+    }
+    if(!IsOne(m)) factor_(f,m);
 }
\ No newline at end of file
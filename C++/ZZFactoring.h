@@ -0,0 +1,94 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __ZZFactoring_h__
+#define __ZZFactoring_h__
+
+#include<NTL/ZZ.h>
+#include<NTL/pair.h>
+#include<iostream>
+
+// method by which a factor is found
+#define FACTOR_TRYDIV 0// trial division
+#define FACTOR_PRIME  1// prime power test
+#define FACTOR_RHO    2// brent_rho
+#define FACTOR_MPQS   3// mpqs
+#define FACTOR_PM1    4// pollard p-1
+#define FACTOR_PP1    5// williams p+1
+#define FACTOR_POWER  6// perfect power
+#define FACTOR_SQUFOF 7// squfof (word size)
+
+struct FactorParams {
+    // parameters of factoring pipeline in factor_()
+    //   IsPrimePower -> IsPerfectPower -> pm1 -> pp1 -> brent_rho -> mpqs
+    // or if n < NTL_SP_BOUND
+    //   IsPrime64 -> IsPerfectPower -> squfof
+    long pm1_B1, pm1_B2;// bounds of stage 1,2 of p-1 (skipped if B1<=0)
+    long pp1_B1, pp1_B2;// bounds of stage 1,2 of p+1 (skipped if B1<=0)
+    long pp1_seeds;// number of seeds tried by p+1 (1 or 2)
+    long pm1_bits;// p-1 and p+1 are tried if n has this many bits or more
+    double rho_time;// timeout of brent_rho in seconds
+    long mpqs_workers;// worker processes of mpqs (0: in this process)
+    FactorParams();// default values
+};
+
+// parameters are set for the calling thread only (thread_local);
+// they do not reach threads of NTL thread pool, which use defaults,
+// so call SetFactorParams in each worker that calls factor
+void SetFactorParams(const FactorParams& p);
+const FactorParams& GetFactorParams();
+
+struct FactorStats {
+    // statistics of factoring pipeline; times are in seconds
+    double t_trydiv;// trial division in factor()
+    double t_prime;// IsPrimePower
+    double t_rho;// brent_rho
+    double t_pm1, t_pp1;// pm1, pp1
+    double t_squfof;// squfof
+    double t_base;// mpqs factor base setup
+    double t_sieve;// mpqs sieving
+    double t_trial;// mpqs trial division of candidates
+    double t_kernel;// mpqs linear algebra and square root
+    long rho_calls, rho_iter, rho_fail;// fail = timeout
+    long pm1_calls, pm1_stage2, pp1_calls, pp1_stage2;
+    // stage2 = number of calls that reached stage 2
+    long squfof_calls, squfof_rho;// rho = calls that fell back to rho
+    long mpqs_calls, mpqs_base, mpqs_poly, mpqs_rel;
+    long mpqs_rows, mpqs_cols;// matrix dimensions
+    NTL::Vec<NTL::Pair<NTL::ZZ, long> > found;
+    // (factor, method) in the order they are found
+    FactorStats() { clear(); }
+    void clear();
+};
+
+// statistics are recorded in the object set by SetFactorStats
+// by the same thread (thread_local), so factor called in NTL pool
+// threads is not recorded; FactorStats is not thread-safe and must
+// not be shared by threads; recording is disabled if it is null
+// or if NO_FACTOR_STATS is defined at compile time
+void SetFactorStats(FactorStats *s);
+#ifdef NO_FACTOR_STATS
+inline FactorStats *GetFactorStats() { return 0; }
+#else
+FactorStats *GetFactorStats();
+#endif
+
+void WriteJSON(std::ostream& s, const FactorStats& a);
+// output a to s in JSON format
+
+// distributed mpqs (POSIX only)
+// coordinator sends ranges of q to workers over connected
+// stream sockets (AF_UNIX or TCP) and collects relations;
+// relations are verified and deduplicated before linear algebra
+long mpqs(NTL::ZZ& d, const NTL::ZZ& n, const NTL::Vec<int>& fd);
+// coordinator; fd = sockets connected to MPQSWorker
+// return 0 if 1 < d < n is found, -1 or -2 if failure
+long mpqs(NTL::ZZ& d, const NTL::ZZ& n, long w, const char *path=0);
+// start w local worker processes (program path, see mpqs-worker.cpp)
+// connected by socketpair and run coordinator;
+// serial mpqs if no worker is started
+long MPQSWorker(int fd);
+// serve coordinator on socket fd until it sends stop
+// return 0 if stopped, -1 if connection is lost
+
+#endif // __ZZFactoring_h__
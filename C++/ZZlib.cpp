@@ -1,4 +1,34 @@
-#include<cstdlib>
+#include<NTL/ZZ.h>
+#include<NTL/BasicThreadPool.h>
+using namespace NTL;
+
+#define SMALL_PRIME_BOUND (1<<20)
+
+static unsigned long MulMod64(unsigned long a, unsigned long b, unsigned long n)
+// return a*b mod n without overflow
+{ return (unsigned __int128)a*b%n; }
+
+static unsigned long PowerMod64(unsigned long a, unsigned long e, unsigned long n)
+// return a^e mod n
+{
+    unsigned long b(1);
+    for(; e; e>>=1) {
+        if(e&1) b = MulMod64(b,a,n);
+        a = MulMod64(a,a,n);
+    }
+    return b;
+}
+
+static unsigned long RandomWord64()
+// return random word by xorshift64* generator
+// state is local to each thread
+{
+    static thread_local unsigned long s(0x9e3779b97f4a7c15UL);
+    s ^= s>>12;
+    s ^= s<<25;
+    s ^= s>>27;
+    return s*0x2545f4914f6cdd1dUL;
+}
 
 long Jacobi(long a, long b)
 // input:
@@ -25,31 +55,143 @@ long Jacobi(long a, long b)
 
 long SqrRootMod(long a, long p)
 // input:
-//   a = integer, 0 <= a < p
-//   p = odd prime
+//   a = integer, 0 <= a < p, (a/p) = 1
+//   p = prime
 // return:
 //   x such that x^2 = a (mod p)
-//   by Cipolla method
-{
-    if(a==0) return 0;
-    long d, s((p+1)>>1);
-    long b,c0(1),c1(0),x0,x1(1);
-    do {
-        b = rand()%p;
-        d = (b*b-a)%p;
-        if(d<0) d+=p;
-    } while(Jacobi(d,p) >= 0);
-    for(x0=b;;) {
-        if(s&1) {
-            b = (c0*x0 + c1*x1%p*d)%p;
-            c1 = (c0*x1 + c1*x0)%p;
-            c0 = b;
-        }
-        s>>=1;
-        if(s==0) return b;
-        b = (x0*x0 + x1*x1%p*d)%p;
-        x1 = (x0*x1<<1)%p;
-        x0 = b;
+//   x = a^{(p+1)/4} if p==3 (mod 4)
+//   else by Tonelli-Shanks method
+{
+    if(a==0 || p==2) return a;
+    if((p&3)==3) return PowerMod64(a, (p+1)>>2, p);
+    long i,m,s;
+    unsigned long b,c,q(p-1),t,x,z;
+    for(s=0; (q&1)==0; s++) q>>=1;
+    do z = RandomWord64()%p;
+    while(Jacobi(z,p) >= 0);
+    c = PowerMod64(z,q,p);
+    x = PowerMod64(a,(q+1)>>1,p);
+    t = PowerMod64(a,q,p);
+    for(m=s; t!=1; m=i) {
+        for(i=1, b=MulMod64(t,t,p); b!=1; i++) b = MulMod64(b,b,p);
+        for(b=c; --m > i;) b = MulMod64(b,b,p);
+        x = MulMod64(x,b,p);
+        c = MulMod64(b,b,p);
+        t = MulMod64(t,c,p);
     }
+    return x;
+}
+
+void SqrRootMod(Vec<long>& x, const Vec<long>& a, const Vec<long>& p)
+// x[i] = SqrRootMod(a[i], p[i]) for i=0,...,a.length()-1
+// computed in parallel
+{
+    x.SetLength(a.length());
+    NTL_EXEC_RANGE(a.length(), first, last)
+    for(long i=first; i<last; i++) x[i] = SqrRootMod(a[i], p[i]);
+    NTL_EXEC_RANGE_END
 }
 
+static unsigned char *SmallPrimeTable()
+// return bitmap of odd primes below SMALL_PRIME_BOUND
+// bit (n>>1)&7 of byte n>>4 is set if odd n is prime
+{
+    long i,j,N(SMALL_PRIME_BOUND>>4);
+    unsigned char *t = new unsigned char[N];
+    for(i=0; i<N; i++) t[i] = 0xff;
+    t[0] &= ~1;// 1 is not prime
+    for(i=3; i*i < SMALL_PRIME_BOUND; i+=2) {
+        if((t[i>>4]>>((i>>1)&7)&1) == 0) continue;
+        for(j=i*i; j < SMALL_PRIME_BOUND; j+=i<<1)
+            t[j>>4] &= ~(1<<((j>>1)&7));
+    }
+    return t;
+}
+
+long IsPrime64(unsigned long n)
+// return 1 if n is prime, else return 0
+// by table lookup if n < SMALL_PRIME_BOUND
+// else by Miller-Rabin test with seven bases
+//   which is deterministic for n < 2^64
+// reference: https://miller-rabin.appspot.com
+{
+    static const unsigned char *T(SmallPrimeTable());
+    static const unsigned long B[] =
+        {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+    if(n < SMALL_PRIME_BOUND)
+        return n==2 || (n&1) && (T[n>>4]>>((n>>1)&7)&1);
+    if((n&1)==0) return 0;
+    long i,j,s;
+    unsigned long a,d(n-1);
+    for(s=0; (d&1)==0; s++) d>>=1;
+    for(i=0; i<7; i++) {
+        if((a = B[i]%n) == 0) continue;
+        a = PowerMod64(a,d,n);
+        if(a==1 || a==n-1) continue;
+        for(j=1; j<s; j++)
+            if((a = MulMod64(a,a,n)) == n-1) break;
+        if(j==s) return 0;
+    }
+    return 1;
+}
+
+static void half(ZZ& b, const ZZ& a, const ZZ& n)
+// b = a/2 mod n; assume n odd and 0 <= a < n
+{
+    if(IsOdd(a)) add(b,a,n);
+    else b=a;
+    b >>= 1;
+}
+
+long BPSW(const ZZ& n)
+// return 1 if n is probable prime by Baillie-PSW test
+//   (strong test to base 2 and strong Lucas test)
+// else return 0
+// if n < 2^64, n is tested deterministically by IsPrime64
+// reference:
+//   R. Baillie and S. S. Wagstaff, Jr.
+//     "Lucas Pseudoprimes" Math. Comp. 35 (1980) 1391
+{
+    if(sign(n) <= 0) return 0;
+    if(NumBits(n) <= 64) return IsPrime64(to_ulong(n));
+    long i,j,s,D(5);
+    ZZ d,t,U(1),V(1),W,Qk,Dn,Qn;
+    PrimeSeq ps;
+    while((i = ps.next()) < 100)
+        if(divide(n,i)) return 0;
+    if(MillerWitness(n, ZZ(2))) return 0;
+    SqrRoot(t,n);
+    if(sqr(t)==n) return 0;
+    for(;; D = (D>0 ? -D-2 : -D+2)) {
+        rem(t, ZZ(D), n);
+        if((j = Jacobi(t,n)) < 0) break;
+        if(j==0) return 0;
+    }
+    rem(Dn, ZZ(D), n);
+    rem(Qn, ZZ((1-D)/4), n);
+    Qk = Qn;
+    add(d,n,1);
+    s = MakeOdd(d);
+    for(i=NumBits(d)-2; i>=0; i--) {// P=1
+        MulMod(U,U,V,n);
+        SqrMod(V,V,n);
+        SubMod(V,V,Qk,n); SubMod(V,V,Qk,n);
+        SqrMod(Qk,Qk,n);
+        if(bit(d,i)) {
+            AddMod(W,U,V,n);
+            MulMod(t,U,Dn,n);
+            AddMod(V,V,t,n);
+            half(U,W,n);
+            half(V,V,n);
+            MulMod(Qk,Qk,Qn,n);
+        }
+    }
+    if(IsZero(U)) return 1;
+    for(i=0; i<s; i++) {
+        if(IsZero(V)) return 1;
+        SqrMod(V,V,n);
+        SubMod(V,V,Qk,n); SubMod(V,V,Qk,n);
+        SqrMod(Qk,Qk,n);
+    }
+    return 0;
+}
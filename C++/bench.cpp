@@ -0,0 +1,220 @@
+// benchmark of EE library
+// usage: bench [-f csv|json] [-o output] [-b baseline] [-t tolerance]
+//              [-r repeat] [-s seed]
+//   prints median, p90, max and min of time per operation (in sec)
+//   (p90 differs from max only if repeat >= 7)
+//   each benchmark is seeded by seed, its name and bit length
+//   if baseline (csv output of previous run) is given,
+//   flags benchmarks whose median is slower by more than tolerance
+//   and returns 1 if any
+
+#include "EEFactoring.h"
+#include<fstream>
+#include<sstream>
+#include<cstring>
+#include<algorithm>
+using namespace NTL;
+
+#define BENCH_SEED   1
+#define BENCH_WARMUP 2
+#define BENCH_REPEAT 11
+#define BENCH_TOL    0.1
+
+long brent_rho(ZZ&, const ZZ&, double);
+long mpqs(ZZ&, const ZZ&);
+
+struct BenchResult {
+    const char *name;
+    long bits,n;// n = operations per repetition
+    double min,med,p90,max;// seconds per operation
+    double base;// median of baseline (0 if none)
+};
+
+static Vec<BenchResult> results;
+static long REPEAT(BENCH_REPEAT), SEED(BENCH_SEED);
+
+template<class S, class R>
+void bench(const char *name, long l, long n, S setup, R run)
+// setup(l,n) prepares n inputs of length l (untimed)
+// run() operates on them (timed)
+{
+    long i,k;
+    double t;
+    ZZ s(SEED);
+    Vec<double> T;
+    for(const char *c=name; *c; c++) { s *= 131; s += *c; }
+    s *= 131; s += l;
+    SetSeed(s);
+    for(i=0; i<BENCH_WARMUP; i++) { setup(l,n); run(); }
+    for(i=0; i<REPEAT; i++) {
+        setup(l,n);
+        t = GetTime();
+        run();
+        T.append((GetTime() - t)/n);
+    }
+    std::sort(T.begin(), T.end());
+    k = results.length();
+    results.SetLength(k+1);
+    BenchResult& r(results[k]);
+    r.name = name;
+    r.bits = l;
+    r.n = n;
+    r.min = T[0];
+    r.med = T[(REPEAT-1)/2];
+    r.p90 = T[long(0.90*(REPEAT-1) + 0.5)];
+    r.max = T[REPEAT-1];
+    r.base = 0;
+    std::cerr << name << ' ' << l << ' ' << r.med << std::endl;
+}
+
+static void ReadBaseline(const char *file)
+// set results[i].base from csv file written by previous run
+{
+    long i,l;
+    double m;
+    std::string line,name;
+    std::ifstream f(file);
+    if(!f) Error("cannot open baseline");
+    std::getline(f,line);// header
+    while(std::getline(f,line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream s(line);
+        if(!(s >> name >> l >> m)) continue;
+        for(i=0; i<results.length(); i++)
+            if(name == results[i].name && l == results[i].bits)
+                results[i].base = m;
+    }
+}
+
+static void WriteCSV(std::ostream& s)
+{
+    s << "name,bits,median,p90,max,min,n,baseline\n";
+    for(long i=0; i<results.length(); i++) {
+        BenchResult& r(results[i]);
+        s << r.name << ',' << r.bits << ',' << r.med << ',' << r.p90 << ','
+          << r.max << ',' << r.min << ',' << r.n << ',' << r.base << '\n';
+    }
+}
+
+static void WriteJSON(std::ostream& s)
+{
+    s << "[\n";
+    for(long i=0; i<results.length(); i++) {
+        BenchResult& r(results[i]);
+        s << "  {\"name\": \"" << r.name << "\", \"bits\": " << r.bits
+          << ", \"median\": " << r.med << ", \"p90\": " << r.p90
+          << ", \"max\": " << r.max << ", \"min\": " << r.min
+          << ", \"n\": " << r.n << ", \"baseline\": " << r.base << '}'
+          << (i+1 < results.length() ? ",\n" : "\n");
+    }
+    s << "]\n";
+}
+
+int main(int argc, char **argv) {
+    long i,j;
+    double tol(BENCH_TOL);
+    const char *fmt("csv"), *out(0), *base(0);
+    for(i=1; i+1<argc; i+=2) {
+        if(strcmp(argv[i], "-f")==0) fmt = argv[i+1];
+        else if(strcmp(argv[i], "-o")==0) out = argv[i+1];
+        else if(strcmp(argv[i], "-b")==0) base = argv[i+1];
+        else if(strcmp(argv[i], "-t")==0) tol = atof(argv[i+1]);
+        else if(strcmp(argv[i], "-r")==0) REPEAT = atol(argv[i+1]);
+        else if(strcmp(argv[i], "-s")==0) SEED = atol(argv[i+1]);
+        else Error("unknown option");
+    }
+    if(REPEAT < 1) Error("repeat < 1");
+
+    ZZ m;
+    EE p,q,r;
+    Vec<EE> a,b,c,d;
+    Vec<ZZ> n;
+    Vec<Pair<EE, long> > f;
+
+    // random operands of l bits
+    auto RandomPair = [&](long l, long k) {
+        a.SetLength(k); b.SetLength(k); c.SetLength(k); d.SetLength(k);
+        for(j=0; j<k; j++) { RandomLen(a[j],l); RandomLen(b[j],l); }
+    };
+    // prime modulus of l bits and k residues
+    auto RandomMod = [&](long l, long k) {
+        GenPrime(p,l);
+        a.SetLength(k); c.SetLength(k);
+        for(j=0; j<k; j++) { RandomLen(a[j],l); a[j] %= p; }
+    };
+    // k products of two rational primes of l/2 bits
+    auto RandomComposite = [&](long l, long k) {
+        n.SetLength(k);
+        for(j=0; j<k; j++) n[j] = GenPrime_ZZ(l/2) * GenPrime_ZZ(l-l/2);
+    };
+
+    for(long l : {64, 256, 1024}) {
+        bench("mul", l, 1000, RandomPair,
+              [&]{ for(j=0; j<a.length(); j++) mul(c[j],a[j],b[j]); });
+        bench("sqr", l, 1000, RandomPair,
+              [&]{ for(j=0; j<a.length(); j++) sqr(c[j],a[j]); });
+        bench("DivRem", l, 1000,
+              [&](long l, long k) { RandomPair(l,k); for(j=0; j<k; j++) a[j] *= a[j]; },
+              [&]{ for(j=0; j<a.length(); j++) DivRem(c[j],d[j],a[j],b[j]); });
+        bench("GCD", l, 100, RandomPair,
+              [&]{ for(j=0; j<a.length(); j++) GCD(c[j],a[j],b[j]); });
+        bench("XGCD", l, 100, RandomPair,
+              [&]{ for(j=0; j<a.length(); j++) XGCD(r,c[j],d[j],a[j],b[j]); });
+        bench("FactorPrime", l, 10,
+              [&](long l, long k) {
+                  n.SetLength(k);
+                  for(j=0; j<k; j++) do GenPrime(n[j],l); while(n[j]%3 != 1);
+              },
+              [&]{ for(j=0; j<n.length(); j++) FactorPrime(q,n[j]); });
+    }
+    for(long l : {64, 256, 512}) {
+        bench("PowerMod", l, 10, RandomMod,
+              [&]{ norm(m,p); for(j=0; j<a.length(); j++) PowerMod(c[j],a[j],m,p); });
+        bench("ResSymb", l, 100, RandomMod,
+              [&]{ for(j=0; j<a.length(); j++) ResSymb(c[j],a[j],p); });
+        bench("CubRootMod", l, 10,
+              [&](long l, long k) {
+                  RandomMod(l,k);
+                  for(j=0; j<k; j++) PowerMod(a[j],a[j],3,p);
+              },
+              [&]{ for(j=0; j<a.length(); j++) CubRootMod(c[j],a[j],p); });
+        bench("GenPrime", l, 10, [](long, long) {},
+              [&]{ for(j=0; j<10; j++) GenPrime(q,l); });
+    }
+    for(long l : {40, 60}) {
+        bench("brent_rho", l, 10, RandomComposite,
+              [&]{ for(j=0; j<n.length(); j++) brent_rho(m,n[j],60); });
+    }
+    for(long l : {80, 120}) {
+        bench("mpqs", l, 1, RandomComposite,
+              [&]{ for(j=0; j<n.length(); j++) mpqs(m,n[j]); });
+    }
+    for(long l : {16, 32}) {// product of three primes of l bits
+        bench("factor", l, 10,
+              [&](long l, long k) {
+                  a.SetLength(k);
+                  for(j=0; j<k; j++) {
+                      GenPrime(p,l); GenPrime(q,l); GenPrime(r,l,2);
+                      mul(a[j],p,q); a[j] *= r;
+                  }
+              },
+              [&]{ for(j=0; j<a.length(); j++) factor(f,a[j]); });
+    }
+
+    if(base) ReadBaseline(base);
+    std::ofstream fo;
+    if(out) fo.open(out);
+    std::ostream& s(out ? fo : std::cout);
+    if(strcmp(fmt, "json")==0) WriteJSON(s);
+    else WriteCSV(s);
+
+    for(i=j=0; i<results.length(); i++) {
+        BenchResult& r(results[i]);
+        if(r.base > 0 && r.med > r.base*(1+tol)) {
+            std::cerr << "regression: " << r.name << ' ' << r.bits << ' '
+                      << r.base << " -> " << r.med << std::endl;
+            j++;
+        }
+    }
+    return j>0;
+}
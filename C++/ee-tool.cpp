@@ -0,0 +1,214 @@
+// streaming command line tool of EE library
+// usage: ee-tool op [-i input] [-j threads] [-q queue] [-b] [-u]
+//   op = factor, ressymb, cubroot, gcd or prime
+//   each input record is a list of integers separated by spaces
+//     factor  n     : factorization of n into rational primes
+//     factor  x y   : factorization of x+yw into Eisenstein primes
+//     ressymb x y u v : cubic residue symbol (a/p)_3, a=x+yw, p=u+vw
+//     cubroot x y u v : solution z of z^3 == a (mod p) printed as x+yw,
+//                       so z=0 is [0 0] if a==0 (mod p), or 0 if none
+//     gcd     a b   : GCD of rational integers a,b
+//     gcd     x y u v : GCD of x+yw and u+vw
+//     prime   n     : 1 if n is (probable) prime else 0
+//     prime   x y   : 1 if x+yw is Eisenstein prime else 0
+//   records are read from input (default stdin), one per line,
+//     or if -b is given, each record is preceded by its length
+//     in 4 bytes little endian; output is framed in the same way
+//   records are processed by a pool of threads (default all cores)
+//     and at most queue (default 64) records per thread are in flight
+//   results are written in input order,
+//     or if -u is given, as soon as they are ready,
+//     tagged by 0-based record number and a tab
+
+#include "EEFactoring.h"
+#include<fstream>
+#include<sstream>
+#include<cstring>
+#include<cctype>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<deque>
+#include<map>
+using namespace NTL;
+
+#define TOOL_QUEUE 64
+
+static long ParseRecord(Vec<ZZ>& v, const std::string& s)
+// v = integers in s; return 0 if s is malformed
+{
+    std::istringstream is(s);
+    std::string t;
+    v.SetLength(0);
+    while(is >> t) {
+        size_t i(t[0]=='-' || t[0]=='+');
+        if(i==t.size()) return 0;
+        for(; i<t.size(); i++) if(!isdigit(t[i])) return 0;
+        v.SetLength(v.length()+1);
+        conv(v[v.length()-1], t.c_str() + (t[0]=='+'));
+    }
+    return 1;
+}
+
+static std::string Apply(const std::string& op, const std::string& s)
+// return result of op applied to record s
+{
+    std::ostringstream r;
+    Vec<ZZ> v;
+    if(!ParseRecord(v,s)) return "error";
+    long n(v.length());
+    try {
+        if(op=="factor" && n==1) {
+            Vec<Pair<ZZ, long> > f;
+            factor(f,v[0]);
+            r << f;
+        }
+        else if(op=="factor" && n==2) {
+            Vec<Pair<EE, long> > f;
+            factor(f, EE(v[0],v[1]));
+            r << f;
+        }
+        else if((op=="ressymb" || op=="cubroot") && n==4) {
+            EE a(v[0],v[1]),p(v[2],v[3]),c;
+            a %= p;
+            ResSymb(c,a,p);
+            if(op=="ressymb") r << c;
+            else if(IsZero(c)) r << a;// a==0 (mod p) has root 0
+            else if(!IsOne(c)) r << 0;
+            else { CubRootMod(c,a,p); r << c; }
+        }
+        else if(op=="gcd" && n==2) r << GCD(v[0],v[1]);
+        else if(op=="gcd" && n==4) {
+            EE d;
+            GCD(d, EE(v[0],v[1]), EE(v[2],v[3]));
+            r << d;
+        }
+        else if(op=="prime" && n==1) r << BPSW(v[0]);
+        else if(op=="prime" && n==2) r << ProbPrime(EE(v[0],v[1]));
+        else return "error";
+    }
+    catch(std::exception&) { return "error"; }
+    return r.str();
+}
+
+struct ToolPool {
+    std::string op;
+    long capacity;// max number of records in flight
+    bool binary, ordered, done;
+    std::ostream *os;
+    std::mutex m;
+    std::condition_variable ready, space;
+    std::deque<std::pair<long, std::string> > queue;
+    std::map<long, std::string> pending;// results waiting for output
+    long read, written;
+
+    void emit(long id, const std::string& s);
+    void work();
+};
+
+void ToolPool::emit(long id, const std::string& s)
+// write result s of record id; assume m is locked
+{
+    std::string t(s);
+    if(!ordered) t = std::to_string(id) + '\t' + s;
+    if(binary) {
+        unsigned char h[4];
+        for(long i=0; i<4; i++) h[i] = (t.size() >> (8*i)) & 0xff;
+        os->write((const char*)h, 4);
+        os->write(t.data(), t.size());
+    }
+    else *os << t << '\n';
+}
+
+void ToolPool::work()
+// take records from queue and output results until done
+{
+    std::unique_lock<std::mutex> lk(m);
+    for(;;) {
+        ready.wait(lk, [this]{ return !queue.empty() || done; });
+        if(queue.empty()) return;
+        std::pair<long, std::string> r(std::move(queue.front()));
+        queue.pop_front();
+        lk.unlock();
+        std::string s(Apply(op, r.second));
+        lk.lock();
+        if(ordered) {
+            pending[r.first] = s;
+            std::map<long, std::string>::iterator i;
+            while((i = pending.find(written)) != pending.end()) {
+                emit(written++, i->second);
+                pending.erase(i);
+            }
+        }
+        else { emit(r.first, s); written++; }
+        space.notify_all();
+    }
+}
+
+static long ReadRecord(std::istream& is, std::string& s, bool binary)
+// s = next record from is; return 0 at end of input
+{
+    if(!binary) return bool(std::getline(is,s));
+    unsigned char h[4];
+    unsigned long i,l(0);
+    if(!is.read((char*)h, 4)) return 0;
+    for(i=0; i<4; i++) l |= (unsigned long)h[i] << (8*i);
+    s.resize(l);
+    return bool(is.read(&s[0], l));
+}
+
+int main(int argc, char **argv) {
+    long i,nt(std::thread::hardware_concurrency()),q(TOOL_QUEUE);
+    const char *in(0);
+    ToolPool P;
+    if(argc < 2) {
+        std::cerr << "usage: ee-tool op [-i input] [-j threads] "
+                  << "[-q queue] [-b] [-u]" << std::endl;
+        return 1;
+    }
+    P.op = argv[1];
+    P.binary = false;
+    P.ordered = true;
+    for(i=2; i<argc; i++) {
+        if(strcmp(argv[i], "-b")==0) P.binary = true;
+        else if(strcmp(argv[i], "-u")==0) P.ordered = false;
+        else if(i+1 == argc) Error("missing argument");
+        else if(strcmp(argv[i], "-i")==0) in = argv[++i];
+        else if(strcmp(argv[i], "-j")==0) nt = atol(argv[++i]);
+        else if(strcmp(argv[i], "-q")==0) q = atol(argv[++i]);
+        else Error("unknown option");
+    }
+    if(nt < 1) nt = 1;
+    if(q < 1) q = 1;
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(0);// output is written by workers
+    std::ifstream fi;
+    if(in) {
+        fi.open(in, std::ios::binary);
+        if(!fi) Error("cannot open input");
+    }
+    std::istream& is(in ? fi : std::cin);
+    P.os = &std::cout;
+    P.capacity = nt*q;
+    P.done = false;
+    P.read = P.written = 0;
+
+    std::string s;
+    std::vector<std::thread> W;
+    for(i=0; i<nt; i++) W.emplace_back(&ToolPool::work, &P);
+    while(ReadRecord(is, s, P.binary)) {
+        std::unique_lock<std::mutex> lk(P.m);
+        P.space.wait(lk, [&P]{ return P.read - P.written < P.capacity; });
+        P.queue.push_back(std::make_pair(P.read++, s));
+        P.ready.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lk(P.m);
+        P.done = true;
+    }
+    P.ready.notify_all();
+    for(i=0; i<nt; i++) W[i].join();
+    std::cout.flush();
+    return 0;
+}
@@ -18,8 +18,9 @@ main() {
         t1 = t2 = 0;
         for(j=0; j<M; j++) {
             GenPrime(p,l);
+            EEReducer R(p);
             for(k=0; k<N; k++) {
-                RandomLen(a,l); a %= p;
+                RandomLen(a,l); rem(a,a,R);
                 s = GetTime(); ResSymb_(b,a,p);
                 t1 += GetTime() - s;
                 s = GetTime(); ResSymb(a,a,p);
@@ -0,0 +1,59 @@
+// test of distributed mpqs
+// usage: mpqs-test [workers]
+//   factors known semiprimes by mpqs with workers (default 2)
+//   started as processes (mpqs-worker) and as threads on socketpairs
+//   returns 1 if any factor is wrong
+
+#include "ZZFactoring.h"
+#include<thread>
+#include<vector>
+#include<cstdlib>
+#include<unistd.h>
+#include<sys/socket.h>
+using namespace NTL;
+
+#define TEST_WORKERS 2
+
+static long check(const ZZ& d, const ZZ& p, const ZZ& q, const char *what)
+// return 0 if d is p or q, else 1
+{
+    if(d==p || d==q) return 0;
+    std::cerr << "mpqs-test: " << what << " found " << d << std::endl;
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    long i,w(TEST_WORKERS),r(0);
+    int s[2];
+    ZZ p,q,n,d;
+    Vec<int> fd,wd;
+    std::vector<std::thread> W;
+    if(argc>1) w = atol(argv[1]);
+    if(w<2) w = 2;
+    p = (ZZ(1)<<61) - 1;// Mersenne primes
+    q = (ZZ(1)<<89) - 1;
+    mul(n,p,q);
+
+    if(access("./mpqs-worker", X_OK)) {
+        std::cerr << "mpqs-test: ./mpqs-worker not found" << std::endl;
+        return 1;
+    }
+    if(mpqs(d, n, w, "./mpqs-worker")) d = 0;
+    r |= check(d,p,q,"processes");
+
+    for(i=0; i<w; i++) {
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, s)) return 1;
+        fd.append(s[0]);
+        wd.append(s[1]);
+        W.push_back(std::thread(MPQSWorker, s[1]));
+    }
+    if(mpqs(d, n, fd)) d = 0;
+    r |= check(d,p,q,"threads");
+    for(i=0; i<w; i++) {
+        W[i].join();
+        close(fd[i]);
+        close(wd[i]);
+    }
+    if(r==0) std::cout << "ok" << std::endl;
+    return r;
+}
@@ -0,0 +1,11 @@
+// worker process of distributed mpqs
+// usage: mpqs-worker
+//   serves coordinator on the stream socket of stdin until it sends stop
+//   started by mpqs(d,n,w) in ZZFactoring.h, which finds this program
+//   by its path argument, $MPQS_WORKER, or ./mpqs-worker
+
+#include "ZZFactoring.h"
+
+int main() {
+    return MPQSWorker(0) ? 1:0;
+}
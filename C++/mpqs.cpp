@@ -3,6 +3,18 @@
 
 #include<NTL/vec_ZZ_p.h>
 #include<NTL/mat_GF2.h>
+#include<map>
+#include<set>
+#include<string>
+#include<sstream>
+#include<cstdlib>
+#include<unistd.h>
+#include<fcntl.h>
+#include<signal.h>
+#include<poll.h>
+#include<sys/socket.h>
+#include<sys/wait.h>
+#include "ZZFactoring.h"
 using namespace NTL;
 
 #define MPQS_MAXLEN 180
@@ -10,121 +22,171 @@ using namespace NTL;
 #define MPQS_INTVL  1
 #define MPQS_SIEV   1
 #define MPQS_EXTRA  10
+#define MPQS_UNIT   8 // polynomials per work unit of distributed mpqs
+#define MPQS_WORKER "./mpqs-worker" // default path of worker program
+#define LN2R 1.4426950408889634 // 1/log(2)
 
 long Jacobi(long, long);
 long SqrRootMod(long, long);
+void SqrRootMod(Vec<long>&, const Vec<long>&, const Vec<long>&);
 
-long mpqs(ZZ& d, const ZZ& n)
-// input:
-//   n = odd integer, not prime power, n>2000
-// output:
-//   d = divisor of n, 1 < d < n
-//       by quadratic sieve method
-// return:
-//   0 if successful, -1 or -2 if failure
-// reference:
-//   R. Crandall and C. Pomerance
-//     "Prime Numbers: A Computational Perspective"
-//     2nd edition (Springer) section 6.1
+struct MPQSBase {
+    // factor base and sieve parameters for n
+    ZZ n;
+    Vec<long> F;// -1 is not included; F[0]=2
+    Vec<long> S;// S[i]^2 == n (mod F[i])
+    Vec<char> LF;// LF[i] = log_2(F[i])
+    long K;// number of primes in F
+    long M;// sieve interval is [-M,M]
+    long U;// 2M+1
+    long N;// number of relations needed
+    long T;// threshold of sieve
+    ZZ q0;// first candidate for q
+};
+
+struct MPQSRel {
+    // relation u^2 == q^2 * (-1)^e[K] * prod F[j]^e[j] (mod n)
+    ZZ u;// 0 <= u < n
+    ZZ q;// a = q^2 is leading coefficient of polynomial
+    Vec<long> e;// exponents of F[0],...,F[K-1] and sign
+};
+
+static long MPQSSetup(ZZ& d, MPQSBase& B, const ZZ& n, long par)
+// set up factor base B for n
+// square roots S are computed in parallel if par!=0
+// return 1 if d is a prime factor of n found in factor base, else 0
 {
-    if(NumBits(n) > MPQS_MAXLEN) return -1;
-    long i,j,k,l,m,p,r,s,t,K,Q,B,M,U,N,T;
+    long i,j,l,p,b;
     double lnN, lnB;
-    static double LN2R(1./log(2));
-    ZZ a,b,c,q,u;
-    ZZ_p x,y,z;
-    Vec<long> F,S,sv,rl,FA;
-    Vec<char> LF;
-    vec_ZZ_p FZ,ru;
-    Mat<long> e;
-    mat_GF2 A,X;
-
-    if(&d==&n) return mpqs(d,a=n);
+    ZZ q;
+    B.n = n;
     lnN = log(n);
     lnB = MPQS_BOUND*sqrt(lnN*log(lnN));
-    B = long(exp(lnB));
-
+    b = long(exp(lnB));
     PrimeSeq ps;
-    F.append(ps.next());
-    S.append(1);
-    while((p=ps.next()) <= B) {
+    B.F.SetLength(0);
+    B.S.SetLength(0);
+    B.F.append(ps.next());
+    B.S.append(1);
+    while((p=ps.next()) <= b) {
         l = n%p;
         if((j = Jacobi(l,p)) > 0) {
-            F.append(p);
-            S.append(SqrRootMod(l,p));
+            B.F.append(p);
+            B.S.append(l);
         }
-        else if(j==0) { d=p; return 0; }
+        else if(j==0) { d=p; return 1; }
     }
-    K = F.length();
-    M = long(MPQS_INTVL*B);
-    U = (M<<1)+1;
-    N = K + MPQS_EXTRA;
-    ZZ_p::init(n);
-    sv.SetLength(U);
-    LF.SetLength(K);
-    FZ.SetLength(K);
-    ru.SetLength(N);
-    rl.SetLength(N);
-    e.SetDims(N,K+1);
-
-    for(i=0; i<K; i++) LF[i] = char(round(log(F[i])*LN2R));
-    for(i=0; i<K; i++) conv(FZ[i], F[i]);
-    T = long((0.5*lnN + lnB)*LN2R - MPQS_SIEV*LF[K-1]);
+    if(par) SqrRootMod(B.S,B.S,B.F);
+    else for(i=0; i<B.S.length(); i++) B.S[i] = SqrRootMod(B.S[i], B.F[i]);
+    B.K = B.F.length();
+    B.M = long(MPQS_INTVL*b);
+    B.U = (B.M<<1)+1;
+    B.N = B.K + MPQS_EXTRA;
+    B.LF.SetLength(B.K);
+    for(i=0; i<B.K; i++) B.LF[i] = char(round(log(B.F[i])*LN2R));
+    B.T = long((0.5*lnN + lnB)*LN2R - MPQS_SIEV*B.LF[B.K-1]);
     LeftShift(q,n,1);
-    SqrRoot(q,q); q/=M;
-    SqrRoot(q,q);
-    for(k=0, l=K; k<N; q++) {
-        NextPrime(q,q);
-        if((j = Jacobi(n,q)) < 0) continue;
-        else if(j==0) { d=q; return 0; }
-        sqr(a,q); rem(d,n,q);
-        SqrRootMod(b,d,q);
-        AddMod(c,b,b,q);
-        InvMod(d,c,q);
-        sqr(c,b); sub(c,n,c); c/=q;
-        MulMod(c,c,d,q);
-        MulAddTo(b,c,q);
-        RightShift(d,a,1);
-        if(b>d) sub(b,a,b);
-        sqr(c,b); c-=n; c/=a;
-        for(i=0; i<U; i++) sv[i] = 0;
-        for(j=0; j<K; j++) {
-            if(q==(p=F[j])) continue;
-            r = InvMod(a%p,p);
-            m = b%p;
-            for(t=0, s=S[j]; t<2 && p>=3; t++, s=p-s) {
-                if((i=((s-m)*r+M)%p)<0) i+=p;
-                for(; i<U; i+=p) sv[i] += LF[j];
-            }
-        }
-        for(i=0, s=-M, r=k; i<U && k<N; i++, s++) {
-            if(sv[i] < T) continue;
-            mul(u,a,s); u+=b;
-            add(d,u,b); d*=s; d+=c;
-            if(IsZero(d)) continue;
-            for(j=0; j<=K; j++) e[k][j] = 0;
-            if(sign(d) < 0) e[k][K] = 1;
-            abs(d,d);
-            for(j=0; j<K; j++) {
-                if((p = F[j]) > d) break;
-                while(divide(d,d,p)) e[k][j]++;
-            }
-            if(!IsOne(d)) continue;
-            conv(ru[k], u);
-            rl[k] = l;
-            k++;
+    SqrRoot(q,q); q/=B.M;
+    SqrRoot(B.q0,q);
+    return 0;
+}
+
+static long MPQSPoly(ZZ& d, Vec<MPQSRel>& R, Vec<long>& sv,
+                     const MPQSBase& B, const ZZ& q, long N)
+// append relations found by sieving polynomial
+//   (as+b)^2 - n = a(as^2 + 2bs + c), a = q^2, b^2 - ac = n
+//   over -M <= s <= M until R has N relations
+// sv = work space of length B.U
+// return 1 if d = q divides n, -1 if (n/q) = -1, else 0
+{
+    long i,j,m,p,r,s,t,K(B.K);
+    ZZ a,b,c,u,v;
+    Vec<long> e;
+    FactorStats *st(GetFactorStats());
+    double tm;
+    if((j = Jacobi(B.n,q)) < 0) return -1;
+    else if(j==0) { d=q; return 1; }
+    sqr(a,q); rem(v,B.n,q);
+    SqrRootMod(b,v,q);
+    AddMod(c,b,b,q);
+    InvMod(v,c,q);
+    sqr(c,b); sub(c,B.n,c); c/=q;
+    MulMod(c,c,v,q);
+    MulAddTo(b,c,q);
+    RightShift(v,a,1);
+    if(b>v) sub(b,a,b);
+    sqr(c,b); c-=B.n; c/=a;
+    if(st) tm = GetTime();
+    for(i=0; i<B.U; i++) sv[i] = 0;
+    for(j=0; j<K; j++) {
+        if(q==(p=B.F[j])) continue;
+        r = InvMod(a%p,p);
+        m = b%p;
+        for(t=0, s=B.S[j]; t<2 && p>=3; t++, s=p-s) {
+            if((i=((s-m)*r+B.M)%p)<0) i+=p;
+            for(; i<B.U; i+=p) sv[i] += B.LF[j];
         }
-        if(k>r) {
-            FZ.SetLength(l+1);
-            conv(FZ[l++], q);
+    }
+    if(st) { st->t_sieve += GetTime() - tm; tm = GetTime(); }
+    e.SetLength(K+1);
+    for(i=0, s=-B.M; i<B.U && R.length()<N; i++, s++) {
+        if(sv[i] < B.T) continue;
+        mul(u,a,s); u+=b;
+        add(v,u,b); v*=s; v+=c;
+        if(IsZero(v)) continue;
+        for(j=0; j<=K; j++) e[j] = 0;
+        if(sign(v) < 0) e[K] = 1;
+        abs(v,v);
+        for(j=0; j<K; j++) {
+            if((p = B.F[j]) > v) break;
+            while(divide(v,v,p)) e[j]++;
         }
+        if(!IsOne(v)) continue;
+        R.SetLength(R.length()+1);
+        rem(R[R.length()-1].u, u, B.n);
+        R[R.length()-1].q = q;
+        R[R.length()-1].e = e;
+    }
+    if(st) { st->t_trial += GetTime() - tm; st->mpqs_poly++; }
+    return 0;
+}
+
+static long MPQSKernel(ZZ& d, const MPQSBase& B, const Vec<MPQSRel>& R)
+// d = GCD(x-y, n) where x^2 == y^2 (mod n) is found from
+//   linear dependencies of exponent vectors of relations mod 2
+// return 0 if 1 < d < n, else -2
+{
+    long i,j,k,l,K(B.K),N(R.length());
+    ZZ a,b;
+    ZZ_pPush push(B.n);// modulus of caller is restored on return
+    ZZ_p x,y,z;
+    Vec<long> rl,FA;
+    vec_ZZ_p FZ;
+    mat_GF2 A,X;
+    std::map<ZZ, long> Q;
+    FactorStats *st(GetFactorStats());
+    double tm;
+    if(st) {
+        st->mpqs_rel += N;
+        st->mpqs_rows = N;
+        st->mpqs_cols = K+1;
+        tm = GetTime();
     }
-    F.kill();
-    S.kill();
+    FZ.SetLength(K);
+    for(i=0; i<K; i++) conv(FZ[i], B.F[i]);
+    rl.SetLength(N);
+    for(i=0; i<N; i++) {// index of q in FZ
+        std::map<ZZ, long>::iterator t(Q.find(R[i].q));
+        if(t != Q.end()) { rl[i] = t->second; continue; }
+        Q[R[i].q] = rl[i] = l = FZ.length();
+        FZ.SetLength(l+1);
+        conv(FZ[l], R[i].q);
+    }
+    l = FZ.length();
     A.SetDims(N,K+1);
     FA.SetLength(l);
     for(i=0; i<N; i++)
-        for(j=0; j<=K; j++) if(e[i][j] & 1) set(A[i][j]);
+        for(j=0; j<=K; j++) if(R[i].e[j] & 1) set(A[i][j]);
     kernel(X,A);
     for(k=0; k<X.NumRows(); k++) {
         for(i=0; i<l; i++) FA[i] = 0;
@@ -132,9 +194,9 @@ long mpqs(ZZ& d, const ZZ& n)
         set(y);
         for(i=0; i<N; i++) {
             if(IsZero(X[k][i])) continue;
-            x *= ru[i];
+            mul(x, x, conv<ZZ_p>(R[i].u));
             FA[rl[i]] += 2;
-            for(j=0; j<K; j++) FA[j] += e[i][j];
+            for(j=0; j<K; j++) FA[j] += R[i].e[j];
         }
         for(i=0; i<l; i++) {
             if(FA[i] == 0) continue;
@@ -144,8 +206,294 @@ long mpqs(ZZ& d, const ZZ& n)
         conv(a,x);
         conv(b,y);
         a -= b;
-        GCD(d,a,n);
-        if(d>1 && d<n) return 0;
+        GCD(d,a,B.n);
+        if(d>1 && d<B.n) break;
+    }
+    if(st) st->t_kernel += GetTime() - tm;
+    return (k < X.NumRows() ? 0 : -2);
+}
+
+long mpqs(ZZ& d, const ZZ& n)
+// input:
+//   n = odd integer, not prime power, n>2000
+// output:
+//   d = divisor of n, 1 < d < n
+//       by quadratic sieve method
+// return:
+//   0 if successful, -1 or -2 if failure
+// reentrant; ZZ_p modulus is local to this call
+// reference:
+//   R. Crandall and C. Pomerance
+//     "Prime Numbers: A Computational Perspective"
+//     2nd edition (Springer) section 6.1
+{
+    if(NumBits(n) > MPQS_MAXLEN) return -1;
+    ZZ q;
+    MPQSBase B;
+    Vec<MPQSRel> R;
+    Vec<long> sv;
+    FactorStats *st(GetFactorStats());
+    double tm;
+
+    if(&d==&n) return mpqs(d,q=n);
+    if(st) { st->mpqs_calls++; tm = GetTime(); }
+    if(MPQSSetup(d,B,n,1)) return 0;
+    if(st) { st->t_base += GetTime() - tm; st->mpqs_base = B.K; }
+    sv.SetLength(B.U);
+    for(q=B.q0; R.length() < B.N; q++) {
+        NextPrime(q,q);
+        if(MPQSPoly(d,R,sv,B,q,B.N) > 0) return 0;
+    }
+    return MPQSKernel(d,B,R);
+}
+
+// distributed mpqs
+// coordinator and workers exchange lines of text over stream sockets
+//   coordinator -> worker
+//     n <n>        set up factor base for n
+//     q <q0> <q1>  sieve polynomials of primes q0 <= q < q1
+//     stop         quit
+//   worker -> coordinator
+//     r <u> <q> <j>:<e> ...  relation with nonzero exponents e of F[j]
+//                            (j=K for sign)
+//     d <d>        divisor of n is found
+//     done         end of q range
+//     fail         n is not acceptable
+
+static long PutLine(int fd, const std::string& s)
+// send s and newline to fd; return 0 if successful, else -1
+{
+    std::string t(s + '\n');
+    const char *p(t.c_str());
+    long k,n(t.length());
+    for(; n>0; p+=k, n-=k)
+        if((k = send(fd, p, n, MSG_NOSIGNAL)) <= 0) return -1;
+    return 0;
+}
+
+static long Fill(int fd, std::string& b)
+// append bytes read from fd to b
+// return number of bytes read, 0 at end of file, -1 if error
+{
+    char c[4096];
+    long k(read(fd, c, sizeof(c)));
+    if(k>0) b.append(c,k);
+    return k;
+}
+
+static long GetLine(std::string& s, std::string& b)
+// s = first line of b without newline, which is removed from b
+// return 1 if b has a line, else 0
+{
+    size_t i(b.find('\n'));
+    if(i == std::string::npos) return 0;
+    s = b.substr(0,i);
+    b.erase(0,i+1);
+    return 1;
+}
+
+static std::string ToLine(const MPQSRel& r)
+// relation r in the format above
+{
+    std::ostringstream s;
+    s << "r " << r.u << ' ' << r.q;
+    for(long j=0; j<r.e.length(); j++)
+        if(r.e[j]) s << ' ' << j << ':' << r.e[j];
+    return s.str();
+}
+
+static long FromLine(MPQSRel& r, const std::string& s, const MPQSBase& B)
+// r = relation in line s
+// return 1 if r is valid relation for B, else 0
+{
+    long j,e;
+    char c;
+    ZZ t,v;
+    std::istringstream is(s);
+    if(!(is >> c >> r.u >> r.q) || c!='r') return 0;
+    if(sign(r.u) < 0 || r.u >= B.n || sign(r.q) <= 0) return 0;
+    r.e.SetLength(B.K+1);
+    for(j=0; j<=B.K; j++) r.e[j] = 0;
+    while(is >> j >> c >> e) {// F[j]^e divides sieved value < n
+        if(j<0 || j>B.K || c!=':' || e<=0 || e>NumBits(B.n)) return 0;
+        r.e[j] = e;
+    }
+    SqrMod(t, r.q % B.n, B.n);
+    for(j=0; j<B.K; j++)
+        for(e=r.e[j]; e>0; e--) MulMod(t, t, B.F[j], B.n);
+    if(r.e[B.K] & 1) NegateMod(t, t, B.n);
+    SqrMod(v, r.u, B.n);
+    return v==t;
+}
+
+long MPQSWorker(int fd)
+// input:
+//   fd = stream socket connected to coordinator
+// serve requests of coordinator in the format above
+// return:
+//   0 if stopped by coordinator, -1 if connection is lost
+{
+    long i,ok(0);
+    ZZ n,d,q,q1;
+    MPQSBase B;
+    Vec<MPQSRel> R;
+    Vec<long> sv;
+    std::string b,s,c;
+    for(;;) {
+        while(!GetLine(s,b))
+            if(Fill(fd,b) <= 0) return -1;
+        std::istringstream is(s);
+        is >> c;
+        if(c=="stop") return 0;
+        else if(c=="n" && (is >> n)) {
+            std::ostringstream t;
+            if(NumBits(n) > MPQS_MAXLEN) t << "fail";
+            else if(MPQSSetup(d,B,n,0)) t << "d " << d;
+            if((ok = t.str().empty())) sv.SetLength(B.U);
+            else if(PutLine(fd, t.str())) return -1;
+        }
+        else if(c=="q" && ok && (is >> q >> q1)) {
+            for(;; q++) {
+                NextPrime(q,q);
+                if(q >= q1) break;
+                R.SetLength(0);
+                if(MPQSPoly(d,R,sv,B,q,NTL_MAX_LONG) > 0) {
+                    std::ostringstream t;
+                    t << "d " << d;
+                    if(PutLine(fd, t.str())) return -1;
+                    break;
+                }
+                for(i=0; i<R.length(); i++)
+                    if(PutLine(fd, ToLine(R[i]))) return -1;
+            }
+            if(PutLine(fd,"done")) return -1;
+        }
+        else if(PutLine(fd,"fail")) return -1;
+    }
+}
+
+long mpqs(ZZ& d, const ZZ& n, const Vec<int>& fd)
+// input:
+//   n = odd integer, not prime power, n>2000
+//   fd = stream sockets connected to workers (MPQSWorker)
+// output:
+//   d = divisor of n, 1 < d < n
+//       by quadratic sieve method, where polynomials
+//       are sieved by workers in ranges of q
+// return:
+//   0 if successful, -1 or -2 if failure
+// relations are verified and deduplicated (same u, q and exponents);
+// linear algebra is done by coordinator
+{
+    if(NumBits(n) > MPQS_MAXLEN) return -1;
+    long i,k,w(fd.length()),l,r(-1);
+    ZZ q,t;
+    MPQSBase B;
+    Vec<MPQSRel> R;
+    MPQSRel x;
+    Vec<std::string> b;
+    Vec<struct pollfd> P;
+    std::set<std::string> U;// relations in canonical format
+    std::string s;
+    FactorStats *st(GetFactorStats());
+    double tm;
+
+    if(&d==&n) return mpqs(d,t=n,fd);
+    if(st) { st->mpqs_calls++; tm = GetTime(); }
+    if(MPQSSetup(d,B,n,1)) r = 0;
+    if(st) { st->t_base += GetTime() - tm; st->mpqs_base = B.K; }
+    if(r) {
+        l = long(MPQS_UNIT*2*log(B.q0)) + 1;// q range with MPQS_UNIT polys
+        q = B.q0;
+        b.SetLength(w);
+        P.SetLength(w);
+        std::ostringstream m;
+        m << "n " << n;
+        for(i=k=0; i<w; i++) {
+            std::ostringstream u;
+            u << "q " << q << ' ' << q+l;
+            P[i].fd = fd[i];
+            P[i].events = POLLIN;
+            if(PutLine(fd[i], m.str()) || PutLine(fd[i], u.str())) P[i].fd = -1;
+            else { q += l; k++; }
+        }
+    }
+    while(r && k>0 && R.length() < B.N) {// k = number of active workers
+        if(poll(P.elts(), w, -1) < 0) break;
+        for(i=0; i<w && r; i++) {
+            if(P[i].fd < 0 || P[i].revents == 0) continue;
+            if(Fill(fd[i], b[i]) <= 0) { P[i].fd = -1; k--; continue; }
+            while(r && GetLine(s, b[i])) {
+                if(s[0]=='r') {
+                    if(R.length() < B.N && FromLine(x,s,B) &&
+                       U.insert(ToLine(x)).second)
+                        R.append(x);
+                }
+                else if(s[0]=='d') {
+                    std::istringstream is(s.substr(1));
+                    if((is >> t) && t>1 && t<n && divide(n,t)) { d=t; r=0; }
+                }
+                else if(s=="done" && R.length() < B.N) {
+                    std::ostringstream u;
+                    u << "q " << q << ' ' << q+l;
+                    if(PutLine(fd[i], u.str())) { P[i].fd = -1; k--; break; }
+                    q += l;
+                }
+                else if(s=="fail") { P[i].fd = -1; k--; break; }
+            }
+        }
+    }
+    for(i=0; i<w; i++) PutLine(fd[i],"stop");
+    if(r==0) return 0;
+    if(R.length() < B.N) return -1;
+    return MPQSKernel(d,B,R);
+}
+
+long mpqs(ZZ& d, const ZZ& n, long w, const char *path)
+// input:
+//   n = odd integer, not prime power, n>2000
+//   w = number of worker processes
+//   path = worker program (mpqs-worker), or if null,
+//          $MPQS_WORKER or MPQS_WORKER if not set
+// output:
+//   d = divisor of n, 1 < d < n
+//       by distributed mpqs above with w worker processes
+//       connected by socketpair on their stdin
+// return:
+//   0 if successful, -1 or -2 if failure
+// if workers are lost before enough relations are collected
+//   (exec failure, "fail" or crash), serial mpqs is run instead
+// workers are exec'd right after fork, since the caller
+// may have threads (NTL thread pool) that fork does not copy
+{
+    long i,r;
+    int s[2];
+    pid_t p;
+    Vec<int> fd;
+    Vec<long> pid;
+    if(!path && !(path = getenv("MPQS_WORKER"))) path = MPQS_WORKER;
+    char *argv[] = { (char *)path, 0 };
+    if(access(path, X_OK)) return mpqs(d,n);
+    for(i=0; i<w; i++) {
+        if(socketpair(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0, s)) break;
+        if((p = fork()) < 0) { close(s[0]); close(s[1]); break; }
+        if(p==0) {// only async-signal-safe calls until exec
+            if(s[1]!=0) { dup2(s[1],0); close(s[1]); }// clears CLOEXEC
+            else fcntl(0, F_SETFD, 0);
+            execv(path, argv);
+            _exit(127);
+        }
+        close(s[1]);
+        fd.append(s[0]);
+        pid.append(p);
+    }
+    if(fd.length()==0) return mpqs(d,n);
+    r = mpqs(d,n,fd);
+    for(i=0; i<fd.length(); i++) {
+        close(fd[i]);
+        kill(pid[i], SIGTERM);
+        waitpid(pid[i], 0, 0);
     }
-    return -2;
+    if(r==-1) r = mpqs(d,n);
+    return r;
 }
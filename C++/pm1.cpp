@@ -0,0 +1,221 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include<NTL/ZZ.h>
+#include "ZZFactoring.h"
+using namespace NTL;
+
+#define PM1_D 2310 // giant step of stage 2 (2*3*5*7*11)
+#define PM1_GCD_INTVL 64 // giant steps between gcd in stage 2
+
+struct PM1Bounds {
+    // stage 1 exponent and stage 2 primes for bounds B1,B2
+    long B1,B2;
+    ZZ E;// product of maximal powers p^k <= B1 of primes p <= B1
+    Vec<char> S;// S[i] = 1 if 2i+1 is prime, 2i+1 <= B2
+};
+
+static const PM1Bounds& GetBounds(long B1, long B2)
+// return stage 1 exponent and stage 2 primes for B1,B2
+// cached per thread in two slots for pm1 and pp1
+{
+    static thread_local PM1Bounds C[2];
+    static thread_local long k(0);
+    long i,j,n,p,q;
+    for(i=0; i<2; i++)
+        if(C[i].B1 == B1 && C[i].B2 == B2) return C[i];
+    PM1Bounds& c(C[k]);
+    k ^= 1;
+    {// E by product tree
+        Vec<ZZ> v;
+        PrimeSeq ps;
+        while((p = ps.next()) && p <= B1) {
+            for(q=p; q <= B1/p; q*=p);
+            v.append(ZZ(q));
+        }
+        for(n=v.length(); n>1; n=(n+1)>>1) {
+            for(i=0; 2*i+1<n; i++) mul(v[i], v[2*i], v[2*i+1]);
+            if(n&1) swap(v[i], v[n-1]);
+        }
+        if(v.length()) c.E = v[0];
+        else set(c.E);
+        c.B1 = B1;
+    }
+    {// sieve of odd numbers
+        n = (B2+1)>>1;
+        c.S.SetLength(n);
+        for(i=0; i<n; i++) c.S[i] = 1;
+        if(n) c.S[0] = 0;
+        for(i=1; (2*i+1)*(2*i+1) <= B2; i++) {
+            if(!c.S[i]) continue;
+            for(j=(2*i+1)*(2*i+1)>>1; j<n; j+=2*i+1) c.S[j] = 0;
+        }
+        c.B2 = B2;
+    }
+    return c;
+}
+
+static void LucasV(ZZ& v, const ZZ& P, const ZZ& e, const ZZ& n)
+// v = V_e(P) mod n where V_0=2, V_1=P, V_{k+1} = P*V_k - V_{k-1}
+// by binary ladder on (V_k, V_{k+1}); assume e>=0
+{
+    ZZ x(2),y(P),t;
+    for(long i=NumBits(e)-1; i>=0; i--) {
+        MulMod(t,x,y,n);
+        SubMod(t,t,P,n);
+        if(bit(e,i)) { x=t; SqrMod(y,y,n); SubMod(y,y,2,n); }
+        else { y=t; SqrMod(x,x,n); SubMod(x,x,2,n); }
+    }
+    v=x;
+}
+
+static long IsPrimeS(const PM1Bounds& c, long q)
+// return 1 if q is odd prime <= c.B2
+{ return (q&1) && q <= c.B2 && c.S[q>>1]; }
+
+static long stage2(ZZ& d, const ZZ& n, const ZZ& P, long B1, long B2,
+                   const PM1Bounds& c)
+// input:
+//   P = V_E(P0) (p+1) or x+1/x, x = a^E (p-1) mod n
+// output:
+//   d = GCD(n, product of V_{kD}(P) - V_j(P))
+//       over primes q = kD-j or kD+j, B1 < q <= B2, 0 < j < D/2
+//   since V_{kD}-V_j = 0 (mod p) if q divides order of group mod p
+// return:
+//   0 if 1 < d < n, else -1
+// reference:
+//   P. L. Montgomery "Speeding the Pollard and Elliptic Curve
+//     Methods of Factorization" Math. Comp. 48 (1987) 243
+{
+    long i,j,k;
+    ZZ a(1),t,W,U,V;
+    Vec<ZZ> B;
+    B.SetLength(PM1_D/2 + 1);
+    B[0] = 2;
+    B[1] = P;
+    for(j=2; j<=PM1_D/2; j++) {// baby steps V_j
+        MulMod(B[j], B[j-1], P, n);
+        SubMod(B[j], B[j], B[j-2], n);
+    }
+    SqrMod(W, B[PM1_D/2], n);
+    SubMod(W, W, 2, n);// W = V_D
+    k = B1/PM1_D;
+    LucasV(V, W, ZZ(k), n);// V = V_{kD}
+    LucasV(U, W, ZZ(k>0 ? k-1 : 1), n);// U = V_{(k-1)D}
+    for(i=0; k*PM1_D - PM1_D/2 <= B2; k++) {
+        for(j=1; j<PM1_D/2; j+=2) {
+            if(GCD(j,PM1_D) != 1) continue;
+            if(!(k*PM1_D-j > B1 && IsPrimeS(c, k*PM1_D-j)) &&
+               !(k*PM1_D+j > B1 && IsPrimeS(c, k*PM1_D+j))) continue;
+            SubMod(t, V, B[j], n);
+            MulMod(a, a, t, n);
+        }
+        MulMod(t, V, W, n);
+        SubMod(t, t, U, n);
+        U = V;
+        V = t;
+        if(++i % PM1_GCD_INTVL == 0) {
+            GCD(d,a,n);
+            if(!IsOne(d)) break;
+        }
+    }
+    GCD(d,a,n);
+    return (IsOne(d) || d==n) ? -1 : 0;
+}
+
+static long backtrack(ZZ& d, const ZZ& n, const ZZ& x0, long B1, long lucas)
+// redo stage 1 prime by prime when all factors are found at once
+// x = x^{p^k} (p-1) or V_{p^k}(x) (p+1) starting from x0
+// return 0 if 1 < d = GCD(x-1 or x-2, n) < n, else -1
+{
+    long p,q;
+    ZZ x(x0),t;
+    PrimeSeq ps;
+    while((p = ps.next()) && p <= B1) {
+        for(q=p; q <= B1/p; q*=p);
+        if(lucas) LucasV(x, x, ZZ(q), n);
+        else PowerMod(x, x, q, n);
+        sub(t, x, lucas ? 2:1);
+        GCD(d,t,n);
+        if(d==n) return -1;
+        if(!IsOne(d)) return 0;
+    }
+    return -1;
+}
+
+static long PM1Stats(FactorStats *s, double t, long k, long r, long pp1)
+// record call of pm1 (pp1 if pp1!=0), reaching stage 2 if k!=0
+{
+    if(s) {
+        if(pp1) { s->pp1_calls++; s->pp1_stage2 += k; s->t_pp1 += GetTime()-t; }
+        else { s->pm1_calls++; s->pm1_stage2 += k; s->t_pm1 += GetTime()-t; }
+    }
+    return r;
+}
+
+long pm1(ZZ& d, const ZZ& n, long B1, long B2)
+// input:
+//   n = odd composite integer with no small factors
+//   B1,B2 = bounds of stage 1 and 2
+// output:
+//   d = divisor of n, 1 < d < n
+//       by Pollard p-1 method, found if p-1 is B1-smooth
+//       except for one prime factor <= B2 for some p|n
+// return:
+//   0 if successful, -1 if failure
+// reference:
+//   J. M. Pollard "Theorems on factorization and primality testing"
+//     Proc. Cambridge Philos. Soc. 76 (1974) 521
+{
+    ZZ x,t;
+    FactorStats *st(GetFactorStats());
+    double t0(st ? GetTime() : 0);
+    if(&d==&n) return pm1(d, t=n, B1, B2);
+    const PM1Bounds& c(GetBounds(B1, B2));
+    PowerMod(x, ZZ(2), c.E, n);
+    sub(t,x,1);
+    GCD(d,t,n);
+    if(d==n) return PM1Stats(st, t0, 0, backtrack(d,n,ZZ(2),B1,0), 0);
+    if(!IsOne(d)) return PM1Stats(st, t0, 0, 0, 0);
+    if(B2 <= B1) return PM1Stats(st, t0, 0, -1, 0);
+    InvMod(t,x,n);
+    AddMod(t,t,x,n);// V-sequence of x+1/x gives x^k+x^{-k}
+    return PM1Stats(st, t0, 1, stage2(d,n,t,B1,B2,c), 0);
+}
+
+long pp1(ZZ& d, const ZZ& n, long B1, long B2, long seeds)
+// input:
+//   n = odd composite integer with no small factors
+//   B1,B2 = bounds of stage 1 and 2
+//   seeds = number of starting values tried (1 or 2)
+// output:
+//   d = divisor of n, 1 < d < n
+//       by Williams p+1 method, found if p+1 (or p-1)
+//       is B1-smooth except for one prime factor <= B2 for some p|n
+// return:
+//   0 if successful, -1 if failure
+// starting values P0 = 2/7, 6/5 (mod n) are those of Montgomery
+//   which make group order divisible by 6 or 4
+// reference:
+//   H. C. Williams "A p+1 Method of Factoring"
+//     Math. Comp. 39 (1982) 225
+{
+    static const long S[2][2] = {{2,7}, {6,5}};
+    long i,r(-1),k(0);
+    ZZ x,t,P;
+    FactorStats *st(GetFactorStats());
+    double t0(st ? GetTime() : 0);
+    if(&d==&n) return pp1(d, t=n, B1, B2, seeds);
+    const PM1Bounds& c(GetBounds(B1, B2));
+    for(i=0; i<seeds && i<2 && r; i++) {
+        InvMod(P, ZZ(S[i][1]), n);
+        MulMod(P, P, S[i][0], n);
+        LucasV(x, P, c.E, n);
+        sub(t,x,2);
+        GCD(d,t,n);
+        if(d==n) r = backtrack(d,n,P,B1,1);
+        else if(!IsOne(d)) r = 0;
+        else if(B2 > B1) { k=1; r = stage2(d,n,x,B1,B2,c); }
+    }
+    return PM1Stats(st, t0, k, r, 1);
+}
@@ -2,10 +2,23 @@
 //   http://www.shoup.net/ntl
 
 #include<NTL/ZZ.h>
+#include "ZZFactoring.h"
 using namespace NTL;
 
 #define RHO_GCD_INTVL 100
 
+static long RhoStats(FactorStats *s, double t, long k, long r)
+// record k iterations and time since t, return r
+{
+    if(s) {
+        s->rho_calls++;
+        s->rho_iter += k;
+        s->t_rho += GetTime() - t;
+        if(r) s->rho_fail++;
+    }
+    return r;
+}
+
 long brent_rho(ZZ& d, const ZZ& n, double T)
 // input:
 //   n = composite integer, n>=4
@@ -20,14 +33,17 @@ long brent_rho(ZZ& d, const ZZ& n, double T)
 //     BIT Numerical Mathematics 20 (1980) 176
 {
     ZZ u(2),q,s,t;
-    long a,r,i,j;
+    long a,r,i,j,k(0);
+    FactorStats *st(GetFactorStats());
+    double t0;
 
     if(&d==&n) return brent_rho(d,s=n,T);
-    T += GetTime();
+    T += t0 = GetTime();
     for(a=1;; a++) {
         set(q);
         for(r=1; r>0; r<<=1) {
             s=u;
+            k += r;
             for(i=0; i<r; i++) {
                 SqrMod(u,u,n);
                 AddMod(u,u,a,n);
@@ -36,6 +52,7 @@ long brent_rho(ZZ& d, const ZZ& n, double T)
                 t=u;
                 j += RHO_GCD_INTVL;
                 if(j>r) j=r;
+                k += j-i;
                 for(; i<j; i++) {
                     SqrMod(u,u,n);
                     AddMod(u,u,a,n);
@@ -44,17 +61,18 @@ long brent_rho(ZZ& d, const ZZ& n, double T)
                 }
                 GCD(d,q,n);
                 if(!IsOne(d)) goto a;
-                if(GetTime() > T) return -1;
+                if(GetTime() > T) return RhoStats(st,t0,k,-1);
             }
         }
 a:      ;
-        if(d<n) return 0;
+        if(d<n) return RhoStats(st,t0,k,0);
         do {
+            k++;
             SqrMod(t,t,n);
             AddMod(t,t,a,n);
             sub(q,s,t);
             GCD(d,q,n);
         } while(IsOne(d));
-        if(d<n) return 0;
+        if(d<n) return RhoStats(st,t0,k,0);
     }
 }
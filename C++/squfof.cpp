@@ -0,0 +1,177 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include<cmath>
+#include<NTL/ZZ.h>
+#include "ZZFactoring.h"
+using namespace NTL;
+
+#define HART_BITS 42 // Hart's method is tried for n of 42 bits or less
+#define HART_ITER 4  // Hart's method is tried HART_ITER * n^{1/3} times
+#define RHO_GCD_INTVL 100
+
+static long IsSquare(long& r, long n)
+// return 1 if n = r^2 (r>=0), else 0; assume n>=0
+{
+    r = SqrRoot(n);
+    return r*r == n;
+}
+
+static long power(long a, long k)
+// a^k or NTL_MAX_LONG if it overflows; assume a>=1, k>=1
+{
+    long b(a);
+    for(; k>1; k--) {
+        if(b > NTL_MAX_LONG/a) return NTL_MAX_LONG;
+        b *= a;
+    }
+    return b;
+}
+
+static long root(long n, long k)
+// floor of k-th root of n; assume n>=1, k>=2
+{
+    long r(pow(double(n), 1.0/k));
+    if(r<1) r=1;
+    while(power(r,k) > n) r--;
+    while(power(r+1,k) <= n) r++;
+    return r;
+}
+
+long IsPerfectPower(long& m, long n, long b)
+// input:
+//   n = integer, n>=2
+//   b = lower bound of prime factors of n, b>=2
+// output:
+//   m = integer such that n = m^k, m is not perfect power
+// return:
+//   k if k>=2, else 0
+{
+    long k(1),p,r;
+    PrimeSeq ps;
+    p = ps.next();
+    for(m=n; p*(NumBits(b)-1) < NumBits(m);) {// b^p <= m
+        if(p==2 ? IsSquare(r,m) : power(r = root(m,p), p) == m) {
+            m = r;
+            k *= p;
+        }
+        else p = ps.next();
+    }
+    return k>1 ? k:0;
+}
+
+static long hart(long& d, long n, long T)
+// Hart's one line factoring; T = number of iterations
+// s = ceil(sqrt(ni)), if s^2 - ni = t^2 then d = GCD(s-t, n)
+{
+    long i,s,t,m;
+    for(i=1; i<=T && i <= NTL_MAX_LONG/n/2; i++) {
+        if(!IsSquare(s, n*i)) s++;
+        m = s*s - n*i;
+        if(!IsSquare(t,m)) continue;
+        d = GCD(s-t, n);
+        if(d>1 && d<n) return 0;
+    }
+    return -1;
+}
+
+static long squfof_(long& d, long n, long k)
+// SQUFOF of kn; assume kn <= NTL_MAX_LONG
+{
+    long N(k*n),P0(SqrRoot(N)),P,Pp,Q,Qp,q,b,r,i,B;
+    if(P0*P0 == N) return -1;
+    Qp = 1;
+    Q = N - P0*P0;
+    P = Pp = P0;
+    B = 6*SqrRoot(2*SqrRoot(N));
+    for(i=2; i<B; i++) {// forward cycle to a square form
+        b = (P0 + P)/Q;
+        P = b*Q - P;
+        q = Q;
+        Q = Qp + b*(Pp - P);
+        if((i&1)==0 && IsSquare(r,Q)) break;
+        Qp = q;
+        Pp = P;
+    }
+    if(i>=B) return -1;
+    b = (P0 - P)/r;// inverse square root of the form
+    Pp = P = b*r + P;
+    Qp = r;
+    Q = (N - Pp*Pp)/Qp;
+    do {// reverse cycle to a symmetry point
+        b = (P0 + P)/Q;
+        Pp = P;
+        P = b*Q - P;
+        q = Q;
+        Q = Qp + b*(Pp - P);
+        Qp = q;
+    } while(P != Pp);
+    d = GCD(n,Qp);
+    return (d>1 && d<n) ? 0 : -1;
+}
+
+static long rho(long& d, long n)
+// Pollard rho with Brent's cycle detection; assume n < NTL_SP_BOUND
+{
+    long a,r,i,j,u,s,t,q;
+    for(a=1;; a++) {
+        d = 1;
+        u = 2;
+        q = 1;
+        for(r=1; r>0; r<<=1) {
+            s = u;
+            for(i=0; i<r; i++) u = AddMod(MulMod(u,u,n), a, n);
+            for(i=0; i<r; i+=RHO_GCD_INTVL) {
+                t = u;
+                for(j=i; j<r && j<i+RHO_GCD_INTVL; j++) {
+                    u = AddMod(MulMod(u,u,n), a, n);
+                    q = MulMod(q, SubMod(s,u,n), n);
+                }
+                if((d = GCD(q,n)) != 1) break;
+            }
+            if(d != 1) break;
+        }
+        if(d==n) {// backtrack from t
+            do {
+                t = AddMod(MulMod(t,t,n), a, n);
+                d = GCD(SubMod(s,t,n), n);
+            } while(d==1);
+        }
+        if(d<n) return 0;
+    }
+}
+
+long squfof(long& d, long n)
+// input:
+//   n = odd composite integer, n < NTL_SP_BOUND,
+//       which is not perfect power
+// output:
+//   d = divisor of n, 1 < d < n
+//       by Hart's one line factoring if n is small,
+//       or by Shanks' square forms factorization
+//       with multipliers k such that kn < 2^63,
+//       or by Pollard rho if they fail
+// return:
+//   0 if successful
+// reference:
+//   W. B. Hart "A One Line Factoring Algorithm"
+//     J. Aust. Math. Soc. 92 (2012) 61
+//   J. E. Gower and S. S. Wagstaff, Jr. "Square Form Factorization"
+//     Math. Comp. 77 (2008) 551
+{
+    static const long K[] = {1, 3, 5, 7, 11, 3*5, 3*7, 3*11, 5*7, 5*11, 7*11,
+                             3*5*7, 3*5*11, 3*7*11, 5*7*11, 3*5*7*11};
+    FactorStats *st(GetFactorStats());
+    double t(st ? GetTime() : 0);
+    long i,r(-1);
+    if(st) st->squfof_calls++;
+    if(NumBits(n) <= HART_BITS) r = hart(d, n, HART_ITER*root(n,3));
+    for(i=0; r && i<16 && K[i] <= NTL_MAX_LONG/n; i++)
+        r = squfof_(d, n, K[i]);
+    if(r) {
+        if(st) st->squfof_rho++;
+        r = rho(d,n);
+    }
+    if(st) st->t_squfof += GetTime() - t;
+    return r;
+}
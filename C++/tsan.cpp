@@ -0,0 +1,112 @@
+// stress test of EE library from several threads at once
+// usage: tsan [threads] [rounds]
+//   built by "make tsan" with -fsanitize=thread, which reports
+//   data races in this library (NTL itself is not instrumented)
+//   each thread runs factor, CubRootMod, GenPrime, ResSymb and
+//   SqrRootMod on its own random stream and checks the results
+//   small primes make threads share tables in ResSymbTable pool
+//   returns 1 if any result is wrong
+
+#include "EEFactoring.h"
+#include "ZZFactoring.h"
+#include "ResSymbTable.h"
+#include<atomic>
+#include<thread>
+#include<vector>
+#include<cstdlib>
+using namespace NTL;
+
+#define TSAN_THREADS 4
+#define TSAN_ROUNDS  8
+#define TSAN_SEED    1
+
+long SqrRootMod(long, long);
+
+static std::atomic<long> errors(0);
+
+static void check(long ok, const char *what)
+{
+    if(ok) return;
+    std::cerr << "tsan: wrong result of " << what << std::endl;
+    errors++;
+}
+
+static void run(long i, long rounds)
+// factor parameters and statistics are per thread
+{
+    long j,k,l,r,s;
+    ZZ m,n,u,v;
+    EE a,b,c,p,t,x;
+    Vec<EE> P;
+    Vec<Pair<ZZ, long> > f;
+    Vec<Pair<EE, long> > g;
+    FactorParams fp;
+    FactorStats st;
+    SetSeed(ZZ(TSAN_SEED), i);
+    fp.rho_time = 1;
+    SetFactorParams(fp);
+    if(i&1) SetFactorStats(&st);
+    for(r=0; r<rounds; r++) {
+        GenPrime(u, 28+r);
+        GenPrime(v, 32);
+        mul(n,u,v);
+        factor(f,n);
+        mul(m,f);
+        check(m==n, "factor(ZZ)");
+
+        GenPrime(a, 12+r);
+        GenPrime(b, 16, 2);
+        mul(c,a,b);
+        factor(g,c);
+        mul(t,g);
+        check(IsAssoc(t,c), "factor(EE)");
+
+        GenPrime(P, 4, 20+r, 1+(r&1));
+        for(j=0; j<P.length(); j++)
+            check(ProbPrime(P[j]), "GenPrime(Vec)");
+
+        for(l=4; l<=40; l+=36) {// table and reciprocity
+            GenPrime(p, l);
+            GenPrime(a, l+4); a %= p;
+            norm(m,p); m--; m/=3;
+            ResSymb(c,a,p);
+            PowerMod(t,a,m,p);
+            check(c==t, "ResSymb");
+            if(l==4) {
+                ResSymb(c, a, *GetResSymbTable(p));
+                check(c==t, "ResSymb(ResSymbTable)");
+            }
+            if(!IsOne(c)) continue;
+            CubRootMod(x,a,p);
+            PowerMod(t,x,3,p);
+            check(t==a, "CubRootMod");
+        }
+
+        s = GenPrime_long(30);
+        k = RandomBnd(s);
+        k = MulMod(k,k,s);
+        j = SqrRootMod(k,s);
+        check(MulMod(j,j,s)==k, "SqrRootMod(long)");
+
+        GenPrime(m, 80);
+        RandomBnd(u,m);
+        SqrMod(u,u,m);
+        SqrRootMod(v,u,m);
+        SqrMod(v,v,m);
+        check(u==v, "SqrRootMod(ZZ)");
+    }
+    check(GetFactorParams().rho_time == 1, "SetFactorParams");
+    check(GetFactorStats() == ((i&1) ? &st : 0), "SetFactorStats");
+}
+
+int main(int argc, char **argv) {
+    long i,nt(TSAN_THREADS),nr(TSAN_ROUNDS);
+    if(argc>1) nt = atol(argv[1]);
+    if(argc>2) nr = atol(argv[2]);
+    std::vector<std::thread> W;
+    for(i=0; i<nt; i++) W.push_back(std::thread(run, i, nr));
+    for(i=0; i<nt; i++) W[i].join();
+    if(errors) std::cerr << errors << " errors" << std::endl;
+    else std::cout << "ok" << std::endl;
+    return errors ? 1:0;
+}
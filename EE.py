@@ -360,3 +360,64 @@ def CubRootMod(a,p):
     b = (a.x - b * a.y % n) % n
     F = sp.factor_list(x**3 - b, modulus=n)
     return int(-F[1][0][0].coeff(x,0))%p
+
+
+def _EE_(a):# convert int or (x,y) to EE
+    if isinstance(a,EE): return a
+    elif isinstance(a,tuple): return EE(*a)
+    else: return EE(a)
+
+def ResSymbBatch(A,p):
+    """ A: list of EE, p: EE, return list of EE
+    return [ResSymb(a,p) for a in A]
+    elements of A may be EE, int or (x,y) tuple
+    """
+    return [ResSymb(_EE_(a),p) for a in A]
+
+def CubRootModBatch(A,p):
+    """ A: list of EE, p: EE, return list of EE
+    return [CubRootMod(a,p) for a in A]
+    """
+    return [CubRootMod(_EE_(a),p) for a in A]
+
+def factorBatch(A):
+    """ A: list of EE, return list of dict{EE,int}
+    return [factor(a) for a in A]
+    """
+    return [factor(_EE_(a)) for a in A]
+
+def IsPrimeBatch(A):
+    """ A: list of EE, return list of bool
+    return [IsPrime(a) for a in A]
+    """
+    return [IsPrime(_EE_(a)) for a in A]
+
+def SetNumThreads(n):# number of threads for batch functions
+    pass
+
+#########################################################
+# native implementation by C++ (built by "make python" in C++/)
+# replaces functions above if available;
+# batch functions run in parallel without GIL
+
+try: import _EE
+except ImportError: _EE = None
+
+if _EE:
+    def _factor(f):
+        return {(EE(*p) if p[1] else abs(p[0])): e for p,e in f}
+    def GCD(a,b): return EE(*_EE.GCD(a,b))
+    def XGCD(a,b): return tuple(EE(*d) for d in _EE.XGCD(a,b))
+    def ResSymb(a,b): return EE(*_EE.ResSymb(a,b))
+    def PowerMod(a,k,n): return EE(*_EE.PowerMod(a,k,n))
+    def FactorPrime(p): return EE(*_EE.FactorPrime(p))
+    def factor(a): return _factor(_EE.factor(a))
+    def IsPrime(a): return _EE.IsPrime(a)
+    def GenPrime(l, f=1): return EE(*_EE.GenPrime(l,f))
+    def CubRootMod(a,p): return EE(*_EE.CubRootMod(a,p))
+    def ResSymbBatch(A,p): return [EE(*s) for s in _EE.ResSymbBatch(A,p)]
+    def CubRootModBatch(A,p):
+        return [EE(*x) for x in _EE.CubRootModBatch(A,p)]
+    def factorBatch(A): return [_factor(f) for f in _EE.factorBatch(A)]
+    def IsPrimeBatch(A): return _EE.IsPrimeBatch(A)
+    SetNumThreads = _EE.SetNumThreads